@@ -316,9 +316,15 @@ void MainFrame::OnTimer(wxTimerEvent& event) {
     if (old_date_time != date_time) {
       status_bar_->SetStatusText(date_time, 2);
     }
-  }
 
-  // ToDo: Update the status pane
+    const auto* doc = GetDocument();
+    const auto* project = doc != nullptr ? doc->GetProject() : nullptr;
+    const wxString status = project != nullptr && project->IsEnabling() ?
+        "Loading..." : "";
+    if (status_bar_->GetStatusText(1) != status) {
+      status_bar_->SetStatusText(status, 1);
+    }
+  }
 }
 
 void MainFrame::OnUpdateHideLogView(wxUpdateUIEvent& event) {
@@ -55,6 +55,12 @@ MdfDialog::MdfDialog(wxWindow *parent)
          wxFLP_OPEN | wxFLP_FILE_MUST_EXIST | wxFLP_USE_TEXTCTRL | wxFLP_SMALL);
   file_picker_->SetMinSize({80*8,-1});
 
+  auto* environment = new wxTextCtrl(this, wxID_ANY, wxEmptyString,
+                                     wxDefaultPosition, wxDefaultSize,
+                                     wxTE_LEFT,
+                                     wxTextValidator(wxFILTER_NONE, &environment_));
+  environment->SetMinSize({40*8,-1});
+
   // Fetch initial directory
   const auto& app = wxGetApp();
   const wxString app_name = app.GetAppName();
@@ -71,11 +77,13 @@ MdfDialog::MdfDialog(wxWindow *parent)
   auto* name_label = new wxStaticText(this, wxID_ANY, L"Name:");
   auto* description_label = new wxStaticText(this, wxID_ANY, L"Description:");
   auto* file_label = new wxStaticText(this, wxID_ANY, L"MDF Log File:");
+  auto* environment_label = new wxStaticText(this, wxID_ANY, L"Environment:");
 
   int label_width = 100;
   label_width = std::max(label_width,name_label->GetBestSize().GetX());
   label_width = std::max(label_width, description_label->GetBestSize().GetX());
   label_width = std::max(label_width, file_label->GetBestSize().GetX());
+  label_width = std::max(label_width, environment_label->GetBestSize().GetX());
 
   auto* name_sizer = new wxBoxSizer(wxHORIZONTAL);
   name_label->SetMinSize({label_width, -1});
@@ -92,6 +100,11 @@ MdfDialog::MdfDialog(wxWindow *parent)
   file_sizer->Add(file_label, 0, wxALIGN_CENTER_VERTICAL | wxLEFT , 5);
   file_sizer->Add(file_picker_, 0, wxALIGN_CENTER_VERTICAL | wxLEFT | wxRIGHT, 5);
 
+  auto* environment_sizer = new wxBoxSizer(wxHORIZONTAL);
+  environment_label->SetMinSize({label_width, -1});
+  environment_sizer->Add(environment_label, 0, wxALIGN_CENTER_VERTICAL | wxLEFT , 5);
+  environment_sizer->Add(environment, 0, wxALIGN_CENTER_VERTICAL | wxLEFT | wxRIGHT, 5);
+
   auto* system_sizer = new wxStdDialogButtonSizer();
   system_sizer->AddButton(save_button);
   system_sizer->AddButton(cancel_button);
@@ -101,6 +114,7 @@ MdfDialog::MdfDialog(wxWindow *parent)
   main_sizer->Add(name_sizer, 0, wxALIGN_LEFT | wxTOP | wxBOTTOM | wxEXPAND, 4);
   main_sizer->Add(description_sizer, 0, wxALIGN_LEFT | wxBOTTOM | wxEXPAND, 4);
   main_sizer->Add(file_sizer, 0, wxALIGN_LEFT | wxBOTTOM | wxEXPAND, 4);
+  main_sizer->Add(environment_sizer, 0, wxALIGN_LEFT | wxBOTTOM | wxEXPAND, 4);
 
   main_sizer->Add(system_sizer, 0,
                   wxALIGN_CENTER_HORIZONTAL | wxBOTTOM | wxLEFT | wxRIGHT, 10);
@@ -118,6 +132,7 @@ void MdfDialog::SetSource( const ISource& source) {
   name_ = source.Name();
   description_ = source.Description();
   filename_ = source.Filename();
+  environment_ = source.EnvironmentName();
   TransferDataToWindow();
 }
 
@@ -139,6 +154,11 @@ bool MdfDialog::GetSource(ISource& source) {
     modified = true;
   }
 
+  if (source.EnvironmentName() != environment_.ToStdString()) {
+    source.EnvironmentName(environment_.ToStdString());
+    modified = true;
+  }
+
   return modified;
 }
 
@@ -197,6 +217,7 @@ bool MdfDialog::TransferDataFromWindow() {  // Fix the exe_picker and combo boxe
   name_.Trim(true).Trim(false);
   description_.Trim(true).Trim(false);
   filename_.Trim(true).Trim(false);
+  environment_.Trim(true).Trim(false);
   return ret;
 }
 
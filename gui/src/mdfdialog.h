@@ -27,6 +27,7 @@ class MdfDialog : public wxDialog {
   wxString name_;
   wxString description_;
   wxString filename_;
+  wxString environment_;
 
   wxFilePickerCtrl* file_picker_ = nullptr;
   wxTextCtrl* name_ctrl_ = nullptr;
@@ -5,8 +5,14 @@
 #include "messagelistview.h"
 
 #include <array>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
 #include <string_view>
 
+#include <wx/menu.h>
+#include <wx/textdlg.h>
+
 #include "util/logstream.h"
 #include "windowid.h"
 
@@ -17,6 +23,11 @@ namespace {
 }
 
 namespace bus {
+wxBEGIN_EVENT_TABLE(MessageListView, wxListView)
+    EVT_LIST_ITEM_RIGHT_CLICK(kIdLogListView, MessageListView::OnRightClick)
+    EVT_MENU(kIdGoToTime, MessageListView::OnGoToTime)
+wxEND_EVENT_TABLE()
+
 MessageListView::MessageListView(wxWindow *parent)
     : wxListView(parent, kIdLogListView, wxDefaultPosition, wxSize(400, 100),
                  wxLC_REPORT | wxLC_SINGLE_SEL | wxLC_VIRTUAL) {
@@ -46,26 +57,70 @@ int MessageListView::OnGetItemImage(long item) const {
 
 wxString MessageListView::OnGetItemText(long item, long column) const {
   wxString text;
-  if (item < 0 || column < 0 || source_ == nullptr) {
+  // The messages are not accessible while the source is loading or while
+  // a streaming replay is moving the window.
+  if (item < 0 || column < 0 || !IsReadable() ||
+      static_cast<size_t>(item) >= source_->NofMessages()) {
     return text;
   }
 
-  const IBusMessage* msg = source_->GetMessage(item);
-  if (msg == nullptr) {
-    return text;
-  }
+  const CanFrameView msg = source_->GetMessage(item);
 
   switch (column) {
     case 0: {  // Time column
       const int64_t start_time = static_cast<int64_t>(source_->FirstTime());
-      int64_t temp = static_cast<int64_t>(msg->Timestamp()) - start_time;
+      int64_t temp = static_cast<int64_t>(msg.Timestamp()) - start_time;
       double time = static_cast<double>(temp) / 1'000'000'000;
       text = wxString::FromDouble(time);
       break;
     }
 
     case 1:
-      text = "Data Frame";
+      switch (msg.Type()) {
+        case CanFrameType::RemoteFrame:
+          text = "Remote Frame";
+          break;
+
+        case CanFrameType::ErrorFrame:
+          text = wxString::Format("Error Frame (Bit %u)",
+                                  static_cast<unsigned>(msg.BitPosition()));
+          break;
+
+        case CanFrameType::OverloadFrame:
+          text = "Overload Frame";
+          break;
+
+        default:
+          text = "Data Frame";
+          break;
+      }
+      break;
+
+    case 2:
+      text = wxString::Format(msg.ExtendedId() ? "%08X" : "%03X",
+                              msg.CanId());
+      break;
+
+    case 3: {
+      std::ostringstream data;
+      for (const uint8_t byte : msg.DataBytes()) {
+        if (!data.str().empty()) {
+          data << " ";
+        }
+        data << std::hex << std::uppercase << std::setw(2)
+             << std::setfill('0') << static_cast<int>(byte);
+      }
+      text = wxString::FromUTF8(data.str());
+      break;
+    }
+
+    case 4:
+      if (msg.HasFlag(CanFrameFlag::Edl)) {
+        text = "FD";
+      }
+      if (msg.HasFlag(CanFrameFlag::Dir)) {
+        text += text.empty() ? "Tx" : " Tx";
+      }
       break;
 
     default:
@@ -78,11 +133,54 @@ wxString MessageListView::OnGetItemText(long item, long column) const {
 
 void MessageListView::Update() {
   if (source_ != nullptr) {
-    SetItemCount(source_->NofMessages());
+    SetItemCount(IsReadable() ? source_->NofMessages() : 0);
     Refresh();
   }
 }
 
+void MessageListView::ShowTime(double time) {
+  if (!IsReadable() || time < 0.0) {
+    return;
+  }
+  // Same time base as the time column.
+  const uint64_t abs_time = source_->FirstTime() +
+      static_cast<uint64_t>(std::llround(time * 1'000'000'000));
+  const size_t index = source_->SeekTime(abs_time);
+  Update();
+  if (index >= source_->NofMessages()) {
+    return;
+  }
+  const auto item = static_cast<long>(index);
+  Select(item);
+  Focus(item);
+  EnsureVisible(item);
+}
+
+void MessageListView::OnRightClick(wxListEvent& event) {
+  if (source_ == nullptr) {
+    return;
+  }
+  wxMenu menu("Messages");
+  menu.Append(kIdGoToTime, "Go To Time...",
+              "Show the first message at or after a time");
+  PopupMenu(&menu, event.GetPoint());
+}
+
+void MessageListView::OnGoToTime(wxCommandEvent& event) {
+  const wxString input = wxGetTextFromUser(
+      "Time since the first message [s]:", "Go To Time", "0", this);
+  double time = 0.0;
+  if (input.IsEmpty() || !input.ToCDouble(&time)) {
+    return;
+  }
+  ShowTime(time);
+}
+
+bool MessageListView::IsReadable() const {
+  return source_ != nullptr && !source_->IsEnabling() &&
+         !source_->IsWindowReplaying();
+}
+
 void MessageListView::CheckMessageView() {
 
 }
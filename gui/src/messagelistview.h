@@ -19,6 +19,11 @@ class MessageListView : public wxListView {
 
   void CheckMessageView();
   void Update() override;
+
+  /** \brief Selects the first message at or after the time [s] in the time
+   * column.
+   */
+  void ShowTime(double time);
  protected:
   [[nodiscard]] wxItemAttr* OnGetItemAttr(long item) const override;
   [[nodiscard]] wxItemAttr* OnGetItemColumnAttr(long item, long column) const override;
@@ -28,6 +33,11 @@ class MessageListView : public wxListView {
 
  private:
   MdfTrafficGenerator* source_ = nullptr;
+
+  [[nodiscard]] bool IsReadable() const;
+  void OnRightClick(wxListEvent& event);
+  void OnGoToTime(wxCommandEvent& event);
+  wxDECLARE_EVENT_TABLE();
 };
 
 }  // namespace bus
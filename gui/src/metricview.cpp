@@ -4,6 +4,8 @@
  */
 #include "metricview.h"
 
+#include <ctime>
+#include <iomanip>
 #include <sstream>
 #include <filesystem>
 
@@ -22,6 +24,22 @@ constexpr int kDbRunningBmp = 2;
 constexpr int kDbFailingBmp = 3;
 constexpr int kDbStoppedBmp = 4;
 
+constexpr int kValueColumn = 2;
+constexpr int kTimeColumn = 5;
+constexpr int kRefreshTime = 500;  // ms
+
+/** \brief Returns the local time of day with ms (HH:MM:SS.mmm). */
+std::string TimeToText(uint64_t ns) {
+  const auto seconds = static_cast<std::time_t>(ns / 1'000'000'000);
+  const auto ms = (ns / 1'000'000) % 1'000;
+  std::ostringstream text;
+  if (const std::tm* local = std::localtime(&seconds); local != nullptr) {
+    text << std::put_time(local, "%H:%M:%S") << "." << std::setfill('0')
+         << std::setw(3) << ms;
+  }
+  return text.str();
+}
+
 struct MetricSorted {
   std::string name;
   std::string group;
@@ -36,6 +54,7 @@ namespace bus {
 wxBEGIN_EVENT_TABLE(MetricView, wxPanel)
   EVT_LIST_ITEM_SELECTED(kIdDatabaseList, MetricView::OnItemSelected)
   EVT_LIST_ITEM_RIGHT_CLICK(kIdDatabaseList, MetricView::OnRightClick)
+  EVT_TIMER(kIdMetricTimer, MetricView::OnTimer)
 wxEND_EVENT_TABLE()
 
  MetricView::MetricView(wxSplitterWindow* parent)
@@ -80,6 +99,8 @@ wxEND_EVENT_TABLE()
   sizer->Add(filter_sizer, 0, wxTOP | wxBOTTOM, 5);
   SetSizer(sizer);
 
+  timer_.SetOwner(this, kIdMetricTimer);
+  timer_.Start(kRefreshTime);
 }
 
 ProjectDocument *MetricView::GetDocument() const {
@@ -109,8 +130,9 @@ void MetricView::Redraw() {
   header_ctrl_->SetLabel(header_text);
 
   list_->DeleteAllItems();
+  line_list_.clear();
   IDatabase* database = GetDatabase();
-  if (database == nullptr) {
+  if (database == nullptr || database->IsEnabling()) {
     return;
   }
 
@@ -134,9 +156,56 @@ void MetricView::Redraw() {
                               wxString::FromUTF8(metric->Name()), -1);
     list_->SetItem(index, 1, wxString::FromUTF8(metric->GroupName()));
     // Todo: Fix the rest
+    line_list_.push_back({metric->GroupName(), metric->GroupId(),
+                          metric->Name()});
     ++line;
   }
+  RedrawValues();
+}
+
+/**
+ * @brief Updates the value and time columns.
+ *
+ * The values are read as snapshots, so the decoding isn't blocked. The
+ * metrics are looked up by their keys, as the database may have been
+ * reloaded since the list was drawn.
+ */
+void MetricView::RedrawValues() {
+  const IDatabase* database = GetDatabase();
+  if (database == nullptr || database->IsEnabling() ||
+      static_cast<size_t>(list_->GetItemCount()) != line_list_.size()) {
+    return;
+  }
+  for (size_t line = 0; line < line_list_.size(); ++line) {
+    const auto& key = line_list_[line];
+    const auto* group = database->GetGroup(key.group_name, key.group_id);
+    const auto* metric = group != nullptr ?
+        database->GetMetric(*group, key.name) : nullptr;
+    const MetricValue value = metric != nullptr ? metric->Snapshot()
+                                                : MetricValue();
+    wxString value_text;
+    wxString time_text;
+    if (value.valid) {
+      std::ostringstream text;
+      text << value.value;
+      value_text = wxString::FromUTF8(text.str());
+      time_text = wxString::FromUTF8(TimeToText(value.timestamp));
+    }
+    const auto item = static_cast<long>(line);
+    // Only changed texts are set, which reduces the flicker.
+    if (list_->GetItemText(item, kValueColumn) != value_text) {
+      list_->SetItem(item, kValueColumn, value_text);
+    }
+    if (list_->GetItemText(item, kTimeColumn) != time_text) {
+      list_->SetItem(item, kTimeColumn, time_text);
+    }
+  }
+}
 
+void MetricView::OnTimer(wxTimerEvent&) {
+  if (IsShown()) {
+    RedrawValues();
+  }
 }
 
 void MetricView::OnRightClick(wxListEvent& event) {
@@ -5,10 +5,15 @@
 
 #pragma once
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
 #include <wx/wx.h>
 #include <wx/splitter.h>
 #include <wx/panel.h>
 #include <wx/listctrl.h>
+#include <wx/timer.h>
 
 namespace bus {
 class ProjectView;
@@ -26,19 +31,30 @@ class MetricView : public wxPanel {
   void Update() override;
 
  private:
+  /** \brief Key of the metric on a list line. */
+  struct MetricLine {
+    std::string group_name;
+    uint32_t group_id = 0;
+    std::string name;
+  };
+
   ProjectView* view_ = nullptr;
   wxListView* list_ = nullptr;
   wxStaticText* header_ctrl_ = nullptr;
   wxTextCtrl* filter_name_ctrl_ = nullptr;
   wxTextCtrl* filter_group_ctrl_ = nullptr;
   //wxImageList image_list_;
+  wxTimer timer_;
+  std::vector<MetricLine> line_list_;
 
   void Redraw();
+  void RedrawValues();
 
   wxString MakeHeaderText();
 
   void OnRightClick(wxListEvent& event);
   void OnItemSelected(wxListEvent& event);
+  void OnTimer(wxTimerEvent& event);
   wxDECLARE_EVENT_TABLE();
 };
 
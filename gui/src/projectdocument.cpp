@@ -95,6 +95,9 @@ wxBEGIN_EVENT_TABLE(ProjectDocument, wxDocument)
   EVT_UPDATE_UI(kIdAddUnknownDestination, ProjectDocument::OnUpdateProjectExist)
   EVT_UPDATE_UI(kIdAddMdfDestination, ProjectDocument::OnUpdateProjectExist)
   EVT_MENU(kIdAddUnknownDestination, ProjectDocument::OnAddUnknownDestination)
+
+  EVT_BUTTON(kIdStartSimulation, ProjectDocument::OnStartSimulation)
+  EVT_BUTTON(kIdStopSimulation, ProjectDocument::OnStopSimulation)
 wxEND_EVENT_TABLE()
 
 
@@ -169,6 +172,21 @@ void ProjectDocument::VerifyProjectPath() {
 
 }
 
+BackgroundJob::DoneFunction ProjectDocument::MakeEnableDone() {
+  // The function is called in the job thread.
+  return [this] (bool) {
+    CallAfter([this] () { UpdateAllViews(); });
+  };
+}
+
+void ProjectDocument::StopSynchronizedReplay() {
+  // The coordinator thread reads the sources, so it is stopped before any
+  // source is changed.
+  if (project_ && project_->IsSynchronizedReplayRunning()) {
+    project_->StopSources();
+  }
+}
+
 bool ProjectDocument::DoSaveDocument(const wxString& filename) {
   if (!project_ || !IsModified()) {
     return true;
@@ -184,6 +202,9 @@ bool ProjectDocument::DoOpenDocument(const wxString& filename) {
 
   project_ = std::make_unique<Project>();
   project_->ConfigFile(filename.ToStdString());
+  project_->EnableCallback([this] () {
+    CallAfter([this] () { UpdateAllViews(); });
+  });
   VerifyProjectPath();
 
   const bool read = project_->ReadConfig();
@@ -271,7 +292,7 @@ void ProjectDocument::OnUpdateDatabaseSelected(wxUpdateUIEvent& event) {
 
 void ProjectDocument::OnUpdateActivateDatabase(wxUpdateUIEvent& event) {
   if (const IDatabase* db = GetCurrentDatabase(); db != nullptr) {
-    event.Enable(!db->IsEnabled());
+    event.Enable(!db->IsEnabled() && !db->IsEnabling());
   } else {
     event.Enable(false);
   }
@@ -279,7 +300,7 @@ void ProjectDocument::OnUpdateActivateDatabase(wxUpdateUIEvent& event) {
 
 void ProjectDocument::OnUpdateDeactivateDatabase(wxUpdateUIEvent& event) {
   if (const IDatabase* db = GetCurrentDatabase(); db != nullptr) {
-    event.Enable(db->IsEnabled());
+    event.Enable(db->IsEnabled() || db->IsEnabling());
   } else {
     event.Enable(false);
   }
@@ -538,7 +559,7 @@ void ProjectDocument::OnActivateDatabase(wxCommandEvent& event) {
     return;
   }
   Modify(true);
-  current_db->Enable(true);
+  current_db->EnableAsync(true, MakeEnableDone());
   UpdateAllViews();
 }
 
@@ -549,7 +570,7 @@ void ProjectDocument::OnDeactivateDatabase(wxCommandEvent& event) {
     return;
   }
   Modify(true);
-  current_db->Enable(false);
+  current_db->EnableAsync(false);
   UpdateAllViews();
 }
 
@@ -563,7 +584,7 @@ void ProjectDocument::OnUpdateSourceSelected(wxUpdateUIEvent& event) {
 
 void ProjectDocument::OnUpdateEnableSource(wxUpdateUIEvent& event) {
   if (const ISource* source = GetCurrentSource(); source != nullptr) {
-    event.Enable(!source->IsEnabled());
+    event.Enable(!source->IsEnabled() && !source->IsEnabling());
   } else {
     event.Enable(false);
   }
@@ -571,7 +592,7 @@ void ProjectDocument::OnUpdateEnableSource(wxUpdateUIEvent& event) {
 
 void ProjectDocument::OnUpdateDisableSource(wxUpdateUIEvent& event) {
   if (const ISource* source = GetCurrentSource(); source != nullptr) {
-    event.Enable(source->IsEnabled());
+    event.Enable(source->IsEnabled() || source->IsEnabling());
   } else {
     event.Enable(false);
   }
@@ -668,6 +689,7 @@ void ProjectDocument::OnEditSource(wxCommandEvent& event) {
       if (dialog.ShowModal() != wxID_SAVE) {
         return;
       }
+      StopSynchronizedReplay();
       modified = dialog.GetSource(*current_source);
       break;
     }
@@ -679,6 +701,7 @@ void ProjectDocument::OnEditSource(wxCommandEvent& event) {
       if (dialog.ShowModal() != wxID_SAVE) {
         return;
       }
+      StopSynchronizedReplay();
       modified = dialog.GetSource(*current_source);
       break;
     }
@@ -718,8 +741,9 @@ void ProjectDocument::OnEnableSource(wxCommandEvent& event) {
   if (current_source == nullptr) {
     return;
   }
+  StopSynchronizedReplay();
   Modify(true);
-  current_source->Enable(true);
+  current_source->EnableAsync(true, MakeEnableDone());
   UpdateAllViews();
 }
 
@@ -728,8 +752,9 @@ void ProjectDocument::OnDisableSource(wxCommandEvent& event) {
   if (current_source == nullptr) {
     return;
   }
+  StopSynchronizedReplay();
   Modify(true);
-  current_source->Enable(false);
+  current_source->EnableAsync(false);
   UpdateAllViews();
 }
 
@@ -767,6 +792,20 @@ void ProjectDocument::OnAddUnknownDestination(wxCommandEvent& event) {
   UpdateAllViews();
 }
 
+void ProjectDocument::OnStartSimulation(wxCommandEvent& event) {
+  if (auto* project = GetProject(); project != nullptr) {
+    project->StartSources();
+    UpdateAllViews();
+  }
+}
+
+void ProjectDocument::OnStopSimulation(wxCommandEvent& event) {
+  if (auto* project = GetProject(); project != nullptr) {
+    project->StopSources();
+    UpdateAllViews();
+  }
+}
+
 MainFrame* ProjectDocument::GetMainFrame() const {
   const auto& app = wxGetApp();
   return dynamic_cast<MainFrame*>(app.GetTopWindow());
@@ -46,6 +46,8 @@ class ProjectDocument : public wxDocument {
   std::string current_id_;
 
   void VerifyProjectPath();
+  [[nodiscard]] BackgroundJob::DoneFunction MakeEnableDone();
+  void StopSynchronizedReplay();
 
   void OnUpdateProjectExist(wxUpdateUIEvent& event);
 
@@ -87,6 +89,9 @@ class ProjectDocument : public wxDocument {
   void OnDisableSource(wxCommandEvent& event);
 
   void OnAddUnknownDestination(wxCommandEvent& event);
+
+  void OnStartSimulation(wxCommandEvent& event);
+  void OnStopSimulation(wxCommandEvent& event);
   wxDECLARE_DYNAMIC_CLASS(ProjectDocument);
   wxDECLARE_EVENT_TABLE();
 };
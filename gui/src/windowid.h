@@ -16,6 +16,7 @@ constexpr wxWindowID kIdTimer = 5;
 constexpr wxWindowID kIdLogListView = 6;
 constexpr wxWindowID kIdSourceList = 7;
 constexpr wxWindowID kIdDestinationList = 8;
+constexpr wxWindowID kIdMetricTimer = 9;
 
 constexpr wxWindowID kIdLeftPanel = 20;
 constexpr wxWindowID kIdPropertyPanel = 21;
@@ -64,4 +65,6 @@ constexpr wxWindowID kIdEditDestination = 510;
 constexpr wxWindowID kIdDeleteDestination = 511;
 constexpr wxWindowID kIdEnableDestination = 512;
 constexpr wxWindowID kIdDisableDestination = 513;
+
+constexpr wxWindowID kIdGoToTime = 600;
 }
\ No newline at end of file
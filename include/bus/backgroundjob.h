@@ -0,0 +1,55 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace bus {
+
+/** \brief Runs one job at a time in a worker thread.
+ *
+ * The job function reports its progress and should check IsCancelled()
+ * at regular intervals. The done function is called in the worker
+ * thread when the job is finished, so a GUI needs to forward it to its
+ * own thread. The done function shall not start or wait for the job.
+ */
+class BackgroundJob {
+ public:
+  using JobFunction = std::function<bool()>;
+  using DoneFunction = std::function<void(bool result)>;
+
+  BackgroundJob() = default;
+  ~BackgroundJob();
+  BackgroundJob(const BackgroundJob&) = delete;
+  BackgroundJob& operator=(const BackgroundJob&) = delete;
+
+  /** \brief Starts the job. A running job is cancelled first. */
+  void Start(JobFunction job, DoneFunction done = {});
+  void Cancel();
+  /** \brief Waits until the job is finished. */
+  void Wait();
+
+  [[nodiscard]] bool IsRunning() const { return running_; }
+  [[nodiscard]] bool IsCancelled() const { return cancel_; }
+
+  void Progress(uint64_t done, uint64_t total);
+  /** \brief Returns the progress between 0 and 1. */
+  [[nodiscard]] double Progress() const;
+
+ private:
+  std::thread thread_;
+  std::mutex thread_mutex_;
+  std::atomic<bool> running_ = false;
+  std::atomic<bool> cancel_ = false;
+  std::atomic<uint64_t> done_ = 0;
+  std::atomic<uint64_t> total_ = 0;
+};
+
+}  // namespace bus
@@ -18,6 +18,7 @@ class BrokerEnvironment : public IEnvironment {
    ~BrokerEnvironment() override;
    void Start() override;
    void Stop() override;
+   [[nodiscard]] std::shared_ptr<IBusMessageQueue> CreatePublisher() override;
   private:
    std::unique_ptr<IBusMessageBroker> broker_;
 };
@@ -0,0 +1,103 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+#include "bus/busproperty.h"
+
+namespace util::xml {
+class IXmlNode;
+}
+
+namespace bus {
+
+/** \brief Selects which CAN frames a traffic source reads.
+ *
+ * The filter is applied while the file is read, so filtered frames are
+ * never stored. An empty channel or ID list lets all channels or IDs
+ * through. If any ID is listed, only listed IDs are read. Error and
+ * overload frames have no real ID, so the ID list doesn't apply to them.
+ * The 11-bit IDs are looked up in a bitmap and the 29-bit IDs in a hash
+ * set.
+ * The time window is in seconds relative to the measurement start.
+ */
+class CanFrameFilter {
+ public:
+  static constexpr size_t kNofStandardIds = 2'048;
+  static constexpr uint32_t kMaxExtendedId = 0x1FFFFFFF;
+
+  void Clear();
+  /** \brief Returns true if the filter removes any frames. */
+  [[nodiscard]] bool IsActive() const;
+
+  void AddChannel(uint16_t channel);
+  [[nodiscard]] const std::vector<uint16_t>& Channels() const {
+    return channel_list_;
+  }
+
+  /** \brief Adds an 11-bit or 29-bit CAN ID.
+   *
+   * Returns false if the ID doesn't fit in the ID type. The extended ID
+   * flag (bit 31) is ignored.
+   */
+  [[nodiscard]] bool AddId(uint32_t can_id, bool extended);
+  [[nodiscard]] size_t NofStandardIds() const {
+    return standard_id_bits_.count();
+  }
+  [[nodiscard]] size_t NofExtendedIds() const {
+    return extended_id_set_.size();
+  }
+
+  void TimeWindow(double from_time, double to_time);
+  void ClearTimeWindow() { time_window_ = false; }
+  [[nodiscard]] bool HasTimeWindow() const { return time_window_; }
+  [[nodiscard]] double FromTime() const { return from_time_; }
+  [[nodiscard]] double ToTime() const { return to_time_; }
+
+  /** \brief Returns true if the frame shall be read.
+   *
+   * The has_id argument is false for error and overload frames.
+   */
+  [[nodiscard]] bool Match(uint16_t channel, uint32_t can_id, bool extended,
+                           double time, bool has_id = true) const {
+    if (!channel_list_.empty() &&
+        !std::ranges::binary_search(channel_list_, channel)) {
+      return false;
+    }
+    if (id_filter_ && has_id) {
+      const bool found = extended ? extended_id_set_.contains(can_id) :
+          can_id < kNofStandardIds && standard_id_bits_.test(can_id);
+      if (!found) {
+        return false;
+      }
+    }
+    return !time_window_ || (time >= from_time_ && time <= to_time_);
+  }
+
+  /** \brief Hash of the filter settings. Zero if the filter isn't active. */
+  [[nodiscard]] uint64_t Hash() const;
+
+  void ReadConfig(const util::xml::IXmlNode& source_node);
+  void WriteConfig(util::xml::IXmlNode& source_node) const;
+  void ToProperties(std::vector<BusProperty>& properties) const;
+
+ private:
+  std::vector<uint16_t> channel_list_;  ///< Sorted channel list.
+  std::bitset<kNofStandardIds> standard_id_bits_;
+  std::unordered_set<uint32_t> extended_id_set_;
+  bool id_filter_ = false;
+
+  bool time_window_ = false;
+  double from_time_ = 0.0;
+  double to_time_ = 0.0;
+};
+
+}  // namespace bus
@@ -0,0 +1,86 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "bus/busproperty.h"
+#include "bus/canframestore.h"
+
+namespace bus {
+
+/** \brief Summary of the CAN traffic in a recording.
+ *
+ * The statistics are accumulated frame by frame, typically while the
+ * frames are read. The periods require that the frames of a CAN ID are
+ * added in time order. Statistics of separate streams can be merged.
+ *
+ * The bus load is an estimate based on the nominal frame length without
+ * stuff bits.
+ */
+class CanFrameStatistics {
+ public:
+  /** \brief Statistics of one CAN ID on one bus channel. */
+  struct IdStatistics {
+    uint16_t channel = 0;
+    uint32_t message_id = 0;  ///< Including the extended ID flag (bit 31).
+    uint64_t nof_frames = 0;
+    uint64_t first_time = 0;
+    uint64_t last_time = 0;
+    uint64_t min_period = std::numeric_limits<uint64_t>::max();
+    uint64_t max_period = 0;
+
+    /** \brief Average period in ns. */
+    [[nodiscard]] uint64_t AvgPeriod() const;
+  };
+
+  void Clear();
+  void Add(const CanFrameView& frame);
+  /** \brief Adds the statistics of another stream.
+   *
+   * The periods of an ID in both streams are exact if its frames in the
+   * streams don't overlap in time, as the gap between the streams is then
+   * one period. Returns false if the frames of an ID overlap, as its
+   * periods then need to be computed from the merged stream.
+   */
+  [[nodiscard]] bool Merge(const CanFrameStatistics& statistics);
+  /** \brief Replaces the statistics with one pass over the store. */
+  void Compute(const CanFrameStore& store);
+
+  [[nodiscard]] bool Empty() const { return nof_frames_ == 0; }
+  [[nodiscard]] uint64_t NofFrames() const { return nof_frames_; }
+  [[nodiscard]] uint64_t NofErrorFrames() const { return nof_error_frames_; }
+  [[nodiscard]] uint64_t FirstTime() const { return first_time_; }
+  [[nodiscard]] uint64_t LastTime() const { return last_time_; }
+
+  /** \brief Returns the ID statistics sorted by channel and ID. */
+  [[nodiscard]] std::vector<IdStatistics> IdList() const;
+  [[nodiscard]] const std::array<uint64_t, 16>& DlcCount() const {
+    return dlc_count_;
+  }
+
+  /** \brief Bus load (0-1) of a channel at the nominal bit rate (bit/s). */
+  [[nodiscard]] double BusLoad(uint16_t channel, uint64_t bit_rate) const;
+
+  void ToProperties(std::vector<BusProperty>& properties,
+                    uint64_t bit_rate) const;
+
+ private:
+  std::unordered_map<uint64_t, IdStatistics> id_map_;
+  std::map<uint16_t, uint64_t> channel_bits_;  ///< Bits per bus channel.
+  std::array<uint64_t, 16> dlc_count_ = {};
+  uint64_t nof_frames_ = 0;
+  uint64_t nof_error_frames_ = 0;
+  uint64_t first_time_ = 0;
+  uint64_t last_time_ = 0;
+};
+
+}  // namespace bus
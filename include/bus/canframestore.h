@@ -0,0 +1,230 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace bus {
+
+class FrameCache;
+
+namespace CanFrameFlag {
+constexpr uint16_t Dir = 0x0001;  ///< Transmitted (Tx) frame.
+constexpr uint16_t Srr = 0x0002;
+constexpr uint16_t Edl = 0x0004;  ///< CAN FD frame.
+constexpr uint16_t Brs = 0x0008;
+constexpr uint16_t Esi = 0x0010;
+constexpr uint16_t Rtr = 0x0020;
+constexpr uint16_t WakeUp = 0x0040;
+constexpr uint16_t SingleWire = 0x0080;
+constexpr uint16_t R0 = 0x0100;
+constexpr uint16_t R1 = 0x0200;
+constexpr uint16_t FrameTypeMask = 0x0C00;  ///< CanFrameType (bit 10-11).
+constexpr uint16_t ErrorTypeMask = 0xF000;  ///< Error type (bit 12-15).
+}  // namespace CanFrameFlag
+
+/** \brief Type of CAN frame. The type is stored in the frame flags. */
+enum class CanFrameType : uint8_t {
+  DataFrame = 0,
+  RemoteFrame = 1,
+  ErrorFrame = 2,
+  OverloadFrame = 3
+};
+
+/** \brief Returns the flags with the frame type and error type tag. */
+[[nodiscard]] constexpr uint16_t TagFrameFlags(uint16_t flags,
+                                               CanFrameType type,
+                                               uint8_t error_type = 0) {
+  return static_cast<uint16_t>(
+      (flags & ~(CanFrameFlag::FrameTypeMask | CanFrameFlag::ErrorTypeMask))
+      | (static_cast<uint16_t>(type) << 10)
+      | ((static_cast<uint16_t>(error_type) << 12)
+          & CanFrameFlag::ErrorTypeMask));
+}
+
+/** \brief Lightweight view of a frame in a CAN frame store.
+ *
+ * The view doesn't own the data bytes. The view is invalid when the
+ * store is modified.
+ */
+class CanFrameView {
+ public:
+  CanFrameView() = default;
+  CanFrameView(uint64_t timestamp, uint32_t message_id, uint16_t channel,
+               uint8_t dlc, uint16_t flags, std::span<const uint8_t> data,
+               uint16_t bit_position = 0);
+
+  [[nodiscard]] uint64_t Timestamp() const { return timestamp_; }
+
+  /** \brief CAN ID including the extended ID flag (bit 31). */
+  [[nodiscard]] uint32_t MessageId() const { return message_id_; }
+  [[nodiscard]] uint32_t CanId() const { return message_id_ & 0x1FFFFFFF; }
+  [[nodiscard]] bool ExtendedId() const {
+    return (message_id_ & 0x80000000) != 0;
+  }
+
+  [[nodiscard]] uint16_t BusChannel() const { return channel_; }
+  [[nodiscard]] uint8_t Dlc() const { return dlc_; }
+  [[nodiscard]] uint16_t Flags() const { return flags_; }
+  [[nodiscard]] bool HasFlag(uint16_t flag) const {
+    return (flags_ & flag) != 0;
+  }
+
+  [[nodiscard]] CanFrameType Type() const {
+    return static_cast<CanFrameType>(
+        (flags_ & CanFrameFlag::FrameTypeMask) >> 10);
+  }
+  /** \brief Error type of an error frame. */
+  [[nodiscard]] uint8_t ErrorType() const {
+    return static_cast<uint8_t>((flags_ & CanFrameFlag::ErrorTypeMask) >> 12);
+  }
+  /** \brief Bit position of the error in an error frame. */
+  [[nodiscard]] uint16_t BitPosition() const { return bit_position_; }
+
+  [[nodiscard]] size_t DataLength() const { return data_.size(); }
+  [[nodiscard]] std::span<const uint8_t> DataBytes() const { return data_; }
+
+ private:
+  uint64_t timestamp_ = 0;
+  uint32_t message_id_ = 0;
+  uint16_t channel_ = 0;
+  uint8_t dlc_ = 0;
+  uint16_t flags_ = 0;
+  uint16_t bit_position_ = 0;
+  std::span<const uint8_t> data_;
+};
+
+/** \brief Compact structure-of-arrays store of CAN frames.
+ *
+ * Each frame property is stored in its own column and all data bytes
+ * are stored in one contiguous byte arena. The per-frame overhead is
+ * 25 bytes plus the data bytes.
+ *
+ * All CAN frame types are stored as tagged records. The frame type and
+ * error type are stored in the upper bits of the flags column. Error
+ * frames also store the error bit position as a 2 byte prefix to their
+ * data bytes in the arena, so other frames don't pay for it.
+ *
+ * The store also keeps a sparse time index with the timestamp of every
+ * kTimeIndexStep frame. A time search first searches the small index and
+ * then one block of the timestamp column. The time searches require that
+ * the store is sorted by time.
+ *
+ * The columns can also be read-only views of a memory mapped frame cache.
+ * The store is copied into its own columns when a mapped store is
+ * modified.
+ */
+class CanFrameStore {
+ public:
+  static constexpr size_t kTimeIndexStep = 4'096;
+
+  CanFrameStore();
+
+  void Clear();
+  void Reserve(size_t nof_frames, size_t nof_bytes);
+  void ShrinkToFit();
+
+  void Add(uint64_t timestamp, uint32_t message_id, uint16_t channel,
+           uint8_t dlc, uint16_t flags, std::span<const uint8_t> data,
+           uint16_t bit_position = 0);
+  void Add(const CanFrameView& frame);
+
+  [[nodiscard]] size_t Size() const { return TimestampColumn().size(); }
+  [[nodiscard]] bool Empty() const { return TimestampColumn().empty(); }
+
+  [[nodiscard]] CanFrameView At(size_t index) const;
+  [[nodiscard]] uint64_t Timestamp(size_t index) const {
+    return TimestampColumn()[index];
+  }
+  [[nodiscard]] std::span<const uint64_t> Timestamps() const {
+    return TimestampColumn();
+  }
+
+  /** \brief Number of bytes used by the store. */
+  [[nodiscard]] size_t MemorySize() const;
+  [[nodiscard]] bool IsMapped() const { return static_cast<bool>(mapped_); }
+
+  [[nodiscard]] bool IsSorted() const;
+  void SortByTime();
+
+  /** \brief Returns the index of the first frame at or after the time. */
+  [[nodiscard]] size_t LowerBound(uint64_t time) const;
+
+  /** \brief Returns the index of the first frame after the time. */
+  [[nodiscard]] size_t UpperBound(uint64_t time) const;
+
+  /** \brief Returns the index range [first, last) of frames in [from, to]. */
+  [[nodiscard]] std::pair<size_t, size_t> TimeRange(uint64_t from,
+                                                    uint64_t to) const;
+
+  /** \brief Replaces the content with the time-ordered merge of streams.
+   *
+   * Each stream is typically one channel group and is normally already
+   * time-ordered. Streams that aren't ordered, are sorted before the merge.
+   * Frames with equal timestamps are ordered by stream index.
+   */
+  void Merge(const std::vector<CanFrameStore*>& stream_list);
+
+ private:
+  friend class FrameCache;
+
+  /** \brief Read-only columns in a memory mapped file. */
+  struct MappedColumns {
+    std::shared_ptr<const void> owner;  ///< Keeps the mapping alive.
+    std::span<const uint64_t> timestamps;
+    std::span<const uint32_t> message_ids;
+    std::span<const uint16_t> channels;
+    std::span<const uint8_t> dlcs;
+    std::span<const uint16_t> flags;
+    std::span<const uint64_t> offsets;
+    std::span<const uint8_t> payload;
+    std::span<const uint64_t> time_index;
+  };
+
+  std::shared_ptr<const MappedColumns> mapped_;
+  std::vector<uint64_t> timestamps_;
+  std::vector<uint32_t> message_ids_;
+  std::vector<uint16_t> channels_;
+  std::vector<uint8_t> dlcs_;
+  std::vector<uint16_t> flags_;
+  std::vector<uint64_t> offsets_;  ///< Size() + 1 offsets into the arena.
+  std::vector<uint8_t> payload_;
+  std::vector<uint64_t> time_index_;  ///< Every kTimeIndexStep timestamp.
+
+  void Attach(std::shared_ptr<const MappedColumns> mapped);
+  void Detach();
+
+  [[nodiscard]] std::span<const uint64_t> TimestampColumn() const {
+    return mapped_ ? mapped_->timestamps : timestamps_;
+  }
+  [[nodiscard]] std::span<const uint32_t> MessageIdColumn() const {
+    return mapped_ ? mapped_->message_ids : message_ids_;
+  }
+  [[nodiscard]] std::span<const uint16_t> ChannelColumn() const {
+    return mapped_ ? mapped_->channels : channels_;
+  }
+  [[nodiscard]] std::span<const uint8_t> DlcColumn() const {
+    return mapped_ ? mapped_->dlcs : dlcs_;
+  }
+  [[nodiscard]] std::span<const uint16_t> FlagColumn() const {
+    return mapped_ ? mapped_->flags : flags_;
+  }
+  [[nodiscard]] std::span<const uint64_t> OffsetColumn() const {
+    return mapped_ ? mapped_->offsets : offsets_;
+  }
+  [[nodiscard]] std::span<const uint8_t> PayloadColumn() const {
+    return mapped_ ? mapped_->payload : payload_;
+  }
+  [[nodiscard]] std::span<const uint64_t> TimeIndexColumn() const {
+    return mapped_ ? mapped_->time_index : time_index_;
+  }
+};
+
+}  // namespace bus
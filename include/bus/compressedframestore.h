@@ -0,0 +1,92 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "bus/canframestore.h"
+
+namespace bus {
+
+/** \brief Read-only compressed copy of a time-sorted CAN frame store.
+ *
+ * The frames are stored in blocks of kBlockSize frames. Within a block,
+ * each frame is stored as variable length integers.
+ * - The timestamp is a delta to the previous frame.
+ * - The CAN ID, channel, DLC and flags are an index into a dictionary of
+ *   the unique combinations.
+ * - The data bytes are skipped if they are equal to the previous frame with
+ *   the same dictionary entry in the block.
+ *
+ * A block is decoded when a frame in it is accessed. Each thread has its
+ * own small cache of decoded blocks, so a replay thread and a GUI can read
+ * the store at the same time. A frame view is valid until the same thread
+ * has accessed kDecodeCacheSize other blocks.
+ */
+class CompressedFrameStore {
+ public:
+  static constexpr size_t kBlockSize = 4'096;
+  static constexpr size_t kDecodeCacheSize = 8;
+
+  CompressedFrameStore() = default;
+
+  void Clear();
+  /** \brief Replaces the content. The frames shall be sorted by time. */
+  void Compress(const CanFrameStore& store);
+
+  [[nodiscard]] size_t Size() const { return size_; }
+  [[nodiscard]] bool Empty() const { return size_ == 0; }
+
+  [[nodiscard]] CanFrameView At(size_t index) const;
+  [[nodiscard]] uint64_t Timestamp(size_t index) const;
+  [[nodiscard]] uint64_t FirstTime() const;
+  [[nodiscard]] uint64_t LastTime() const;
+
+  /** \brief Returns the index of the first frame at or after the time. */
+  [[nodiscard]] size_t LowerBound(uint64_t time) const;
+  /** \brief Returns the index of the first frame after the time. */
+  [[nodiscard]] size_t UpperBound(uint64_t time) const;
+  /** \brief Returns the index range [first, last) of frames in [from, to]. */
+  [[nodiscard]] std::pair<size_t, size_t> TimeRange(uint64_t from,
+                                                    uint64_t to) const;
+
+  /** \brief Number of bytes used by the compressed store. */
+  [[nodiscard]] size_t MemorySize() const;
+  /** \brief Number of bytes used by the uncompressed store. */
+  [[nodiscard]] size_t RawSize() const { return raw_size_; }
+
+ private:
+  struct FrameKey {
+    uint32_t message_id = 0;
+    uint16_t channel = 0;
+    uint8_t dlc = 0;
+    uint16_t flags = 0;
+    bool operator==(const FrameKey& key) const = default;
+  };
+
+  struct FrameKeyHash {
+    size_t operator()(const FrameKey& key) const;
+  };
+
+  struct Block {
+    uint64_t first_time = 0;
+    uint64_t last_time = 0;
+    std::vector<uint8_t> data;
+  };
+
+  std::vector<FrameKey> key_list_;
+  std::vector<Block> block_list_;
+  size_t size_ = 0;
+  size_t raw_size_ = 0;
+  uint64_t generation_ = 0;  ///< Unique per Compress(), keys the caches.
+
+  [[nodiscard]] const CanFrameStore& DecodeBlock(size_t block) const;
+  void DecodeBlock(size_t block, CanFrameStore& dest) const;
+};
+
+}  // namespace bus
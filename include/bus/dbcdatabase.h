@@ -5,21 +5,48 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 
 #include <dbc/dbcfile.h>
 
 #include "bus/idatabase.h"
+#include "bus/signaldecoder.h"
 
 namespace bus {
 
+/** \brief Database of the signals in a DBC file.
+ *
+ * The frames may be decoded in another thread than the thread that
+ * enables the database or deletes groups and metrics. Those changes mark
+ * the database as not operable and wait until the decodes in progress are
+ * done, before the metrics and decode plans are changed.
+ */
 class DbcDatabase  : public IDatabase {
  public:
   DbcDatabase();
+  ~DbcDatabase() override;
   void Enable(bool enable) override;
 
+  /** \brief Deletes the group and the decoding of its signals. */
+  void DeleteGroup(std::string name, uint32_t identity) override;
+  /** \brief Deletes the metric and the decoding of its signal. */
+  void DeleteMetric(const DbGroup& group, std::string name) override;
+
+  /** \brief Decodes the signals of a CAN data frame into the metrics. */
+  void ParseMessage(const IBusMessage& message) override;
+  bool ParseBatch(uint32_t message_id, std::span<const CanFrameView> frames,
+                  std::vector<SignalColumn>& columns) const override;
+
+  [[nodiscard]] const SignalDecoder& Decoder() const { return decoder_; }
+
  private:
   std::unique_ptr<dbc::DbcFile> dbc_file_;
+  SignalDecoder decoder_;
+  mutable std::atomic<uint32_t> nof_decoding_ = 0;  ///< Decodes in progress.
+
+  bool StopDecoding();
+  void BuildDecoder();
 };
 
 }  // namespace bus
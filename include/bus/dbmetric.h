@@ -5,24 +5,66 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include <metric/metric.h>
 
 namespace bus {
 
+/** \brief Consistent snapshot of the latest metric value. */
+struct MetricValue {
+  double value = 0.0;
+  uint64_t timestamp = 0;  ///< Time in ns.
+  bool valid = false;
+};
+
+/** \brief Metric of a database group.
+ *
+ * The latest value is kept in a sequence lock (seqlock). The decode thread
+ * updates it wait-free and any number of readers take consistent
+ * snapshots without blocking the writer. There shall only be one writer
+ * at a time.
+ */
 class DbMetric : public metric::Metric {
  public:
   void GroupName(std::string name) {group_name_ = name;}
   [[nodiscard]] const std::string& GroupName() const { return group_name_; }
 
   void GroupId(uint32_t identity) { group_id_ = identity; }
-  [[nodiscard]] uint32_t GroupId() { return group_id_; }
+  [[nodiscard]] uint32_t GroupId() const { return group_id_; }
+
+  /** \brief Sets the latest decoded value and its time (ns). */
+  void Value(double value, uint64_t timestamp);
+  [[nodiscard]] MetricValue Snapshot() const;
+  [[nodiscard]] double Value() const { return Snapshot().value; }
+  [[nodiscard]] uint64_t Timestamp() const { return Snapshot().timestamp; }
+  [[nodiscard]] bool IsValid() const { return Snapshot().valid; }
+  void ResetValue();
 
  private:
   std::string group_name_;
   uint32_t group_id_ = 0;
+
+  // The sequence is odd while the value is written.
+  std::atomic<uint32_t> sequence_ = 0;
+  std::atomic<double> value_ = 0.0;
+  std::atomic<uint64_t> timestamp_ = 0;
+  std::atomic<bool> valid_ = false;
+
+  void Store(const MetricValue& value);
+};
+
+/** \brief Decoded values of one metric from a batch of frames.
+ *
+ * The column holds one value per frame. Values that aren't in a frame are
+ * NaN.
+ */
+struct SignalColumn {
+  const DbMetric* metric = nullptr;
+  std::vector<double> values;
 };
 
 }  // namespace bus
@@ -0,0 +1,58 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "bus/canframestore.h"
+
+namespace bus {
+
+/** \brief Binary sidecar cache of a decoded and time-sorted MDF file.
+ *
+ * The cache file is stored next to the MDF file. It holds the frame store
+ * columns, so a later load only needs to memory map the file. The cache
+ * is keyed by the MDF file path, size, modification time and a hash of
+ * the file header. The content key identifies what was read from the
+ * file, typically a hash of the filter settings. A cache that doesn't
+ * match the MDF file or the content key is ignored. The content key is
+ * part of the cache file name, so each content has its own cache.
+ *
+ * The cache uses the native byte order and is only intended for the
+ * computer that created it.
+ */
+class FrameCache {
+ public:
+  explicit FrameCache(std::string mdf_file, uint64_t content_key = 0);
+
+  [[nodiscard]] const std::string& MdfFile() const { return mdf_file_; }
+  [[nodiscard]] const std::string& CacheFile() const { return cache_file_; }
+
+  /** \brief Returns true if the cache exists and matches the MDF file. */
+  [[nodiscard]] bool IsValid() const;
+
+  /** \brief Maps the cache file into the frame store.
+   *
+   * @param store Store that becomes a read-only view of the cache.
+   * @param start_time Measurement start time (ns since 1970).
+   * @return False if the cache is missing or outdated.
+   */
+  [[nodiscard]] bool Load(CanFrameStore& store, uint64_t& start_time) const;
+
+  /** \brief Writes the frame store to the cache file. */
+  [[nodiscard]] bool Save(const CanFrameStore& store,
+                          uint64_t start_time) const;
+
+  void Remove() const;
+
+ private:
+  std::string mdf_file_;
+  std::string cache_file_;
+  uint64_t content_key_ = 0;
+};
+
+}  // namespace bus
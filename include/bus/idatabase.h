@@ -5,12 +5,17 @@
 
 #pragma once
 
+#include <atomic>
+#include <span>
 #include <string>
 #include <string_view>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
+#include "bus/backgroundjob.h"
 #include "bus/busproperty.h"
+#include "bus/canframestore.h"
 #include "bus/dbgroup.h"
 #include "bus/dbmetric.h"
 
@@ -50,6 +55,18 @@ class IDatabase {
 
   virtual void Enable(bool enable);
 
+  /** \brief Enables the database in a background job.
+   *
+   * The done function is called in the job thread when the enable is
+   * finished. Disabling cancels a running enable and is done directly.
+   */
+  void EnableAsync(bool enable, BackgroundJob::DoneFunction done = {});
+  void CancelEnable();
+  [[nodiscard]] bool IsEnabling() const { return enable_job_.IsRunning(); }
+  [[nodiscard]] double EnableProgress() const {
+    return enable_job_.Progress();
+  }
+
   [[nodiscard]] virtual bool IsEnabled() const {return enabled_; }
   [[nodiscard]] virtual bool IsOperable() const {return operable_; }
 
@@ -60,30 +77,75 @@ class IDatabase {
 
   virtual void ParseMessage(const IBusMessage& message);
 
+  /** \brief Decodes a batch of frames with the same message ID.
+   *
+   * Each signal of the message is written into its own column. This is
+   * intended for offline conversion of recorded traffic. Returns false if
+   * the database can't decode the message.
+   */
+  virtual bool ParseBatch(uint32_t message_id,
+                          std::span<const CanFrameView> frames,
+                          std::vector<SignalColumn>& columns) const;
+
   virtual DbGroup* CreateGroup(std::string name, uint32_t identity);
-  void DeleteGroup(std::string name, uint32_t identity);
+  virtual void DeleteGroup(std::string name, uint32_t identity);
   const std::vector<std::unique_ptr<DbGroup>>& Groups() const {
     return group_list_;
   }
+  [[nodiscard]] DbGroup* GetGroup(const std::string& name,
+                                  uint32_t identity) const;
+  /** \brief Returns one of the groups with the identity. */
+  [[nodiscard]] DbGroup* GetGroup(uint32_t identity) const;
 
   virtual DbMetric* CreateMetric(const DbGroup& group, std::string name);
-  void DeleteMetric(const DbGroup& group, std::string name);
+  virtual void DeleteMetric(const DbGroup& group, std::string name);
   const std::vector<std::unique_ptr<DbMetric>>& Metrics() const {
     return metric_list_;
   }
+  [[nodiscard]] DbMetric* GetMetric(const DbGroup& group,
+                                    const std::string& name) const;
 
  protected:
   std::atomic<bool> enabled_ = false;
   std::atomic<bool> operable_ = false;
   TypeOfDatabase type_ = TypeOfDatabase::Unknown;
+  BackgroundJob enable_job_;  ///< Derived destructors shall cancel it.
 
+  /** \brief The lists are indexed, so use the create and delete functions. */
   std::vector<std::unique_ptr<DbGroup>> group_list_;
   std::vector<std::unique_ptr<DbMetric>> metric_list_;
+
+  /** \brief Deletes all groups and metrics. */
+  void ClearGroups();
+  void ReserveGroups(size_t nof_groups, size_t nof_metrics);
  private:
+  struct GroupKey {
+    std::string name;
+    uint32_t identity = 0;
+    bool operator==(const GroupKey& key) const = default;
+  };
+
+  struct MetricKey {
+    std::string group_name;
+    uint32_t group_id = 0;
+    std::string name;
+    bool operator==(const MetricKey& key) const = default;
+  };
+
+  struct KeyHash {
+    size_t operator()(const GroupKey& key) const;
+    size_t operator()(const MetricKey& key) const;
+  };
+
   std::string name_;
   std::string description_;
 
   std::string filename_;
+
+  // The indexes hold the position in the group and metric lists.
+  std::unordered_map<GroupKey, size_t, KeyHash> group_index_;
+  std::unordered_map<MetricKey, size_t, KeyHash> metric_index_;
+  std::unordered_multimap<uint32_t, DbGroup*> identity_index_;
 };
 
 }  // namespace bus
@@ -8,11 +8,13 @@
 #include <algorithm>
 #include <atomic>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <vector>
 
 #include "bus/busproperty.h"
+#include "bus/ibusmessagequeue.h"
 
 namespace util::xml {
 class IXmlNode;
@@ -69,6 +71,13 @@ class IEnvironment {
   virtual void Start();
   virtual void Stop();
 
+  /** \brief Returns a queue that publish messages onto the environment.
+   *
+   * Returns an empty pointer if the environment doesn't support publishing
+   * or isn't started.
+   */
+  [[nodiscard]] virtual std::shared_ptr<IBusMessageQueue> CreatePublisher();
+
   void WriteConfig(util::xml::IXmlNode& root_node) const;
   void ReadConfig(const util::xml::IXmlNode& env_node);
 
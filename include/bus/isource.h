@@ -9,8 +9,11 @@
 #include <string_view>
 #include <vector>
 #include <atomic>
+#include <memory>
 
+#include "bus/backgroundjob.h"
 #include "bus/busproperty.h"
+#include "bus/ibusmessagequeue.h"
 #include "mdf/isourceinformation.h"
 
 namespace util::xml {
@@ -21,6 +24,7 @@ namespace bus {
 enum class TypeOfSource : int {
   Unknown = 0,
   Mdf = 1,
+  MdfPlaylist = 2,
 };
 
 
@@ -44,15 +48,44 @@ class ISource {
   virtual void Enable(bool enable);
   [[nodiscard]] bool IsEnabled() const {return enabled_; }
 
+  /** \brief Enables the source in a background job.
+   *
+   * The done function is called in the job thread when the enable is
+   * finished. Disabling cancels a running enable and is done directly.
+   * A source that is paced by a synchronized replay is not changed.
+   */
+  void EnableAsync(bool enable, BackgroundJob::DoneFunction done = {});
+  void CancelEnable();
+  [[nodiscard]] bool IsEnabling() const { return enable_job_.IsRunning(); }
+  [[nodiscard]] double EnableProgress() const {
+    return enable_job_.Progress();
+  }
+
   void Filename(std::string filename) { filename_ = std::move(filename); }
   [[nodiscard]] const std::string& Filename() const { return filename_; }
 
+  /** \brief Name of the environment that the source publishes onto. */
+  void EnvironmentName(std::string name) {
+    environment_name_ = std::move(name);
+  }
+  [[nodiscard]] const std::string& EnvironmentName() const {
+    return environment_name_;
+  }
+
+  void Publisher(std::shared_ptr<IBusMessageQueue> publisher) {
+    publisher_ = std::move(publisher);
+  }
+
   void TypeOfBus(mdf::BusType type) { bus_type_ = type; }
   [[nodiscard]] const mdf::BusType TypeOfBus() const { return bus_type_; }
 
   [[nodiscard]] virtual bool IsStarted() const {return started_; }
   [[nodiscard]] virtual bool IsOperable() const {return operable_; }
 
+  /** \brief The source is read by a running replay coordinator. */
+  [[nodiscard]] virtual bool IsSynchronized() const { return false; }
+
+  /** \brief Starts the source. A source that is enabling isn't started. */
   virtual void Start();
   virtual void Stop();
 
@@ -61,15 +94,20 @@ class ISource {
 
   virtual void ToProperties(std::vector<BusProperty>& properties) const;
  protected:
+  virtual void WriteProperties(util::xml::IXmlNode& source_node) const;
+
   TypeOfSource type_ = TypeOfSource::Unknown;
-  bool enabled_ = true;
+  std::atomic<bool> enabled_ = true;  ///< Written by the enable job.
   std::atomic<bool> started_ = false;
   mutable std::atomic<bool> operable_ = false;
+  std::shared_ptr<IBusMessageQueue> publisher_;
+  BackgroundJob enable_job_;  ///< Derived destructors shall cancel it.
 
  private:
   std::string name_;
   std::string description_;
   std::string filename_;
+  std::string environment_name_;
   mdf::BusType bus_type_ = mdf::BusType::Can;
 };
 
@@ -0,0 +1,99 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bus/backgroundjob.h"
+#include "bus/canframefilter.h"
+#include "bus/isource.h"
+#include "bus/replayclock.h"
+
+namespace bus {
+
+class MdfTrafficGenerator;
+
+/** \brief Replays a directory of MDF files as one continuous stream.
+ *
+ * The filename is a directory or a path with a wildcard file name as
+ * "*.mf4". The files are ordered by their measurement start time and
+ * replayed back-to-back against one clock, so the original time between
+ * the files is kept.
+ *
+ * Only the current file and the next file are held in memory. The next
+ * file is loaded in a background job while the current file is replayed.
+ */
+class MdfPlaylist : public ISource {
+ public:
+  /** \brief File in the playlist. */
+  struct PlaylistFile {
+    std::string filename;
+    uint64_t start_time = 0;  ///< Measurement start time (ns since 1970).
+  };
+
+  MdfPlaylist();
+  ~MdfPlaylist() override;
+
+  void Enable(bool enable) override;
+
+  [[nodiscard]] const std::vector<PlaylistFile>& Files() const {
+    return file_list_;
+  }
+  /** \brief Index of the file that is replayed. */
+  [[nodiscard]] size_t CurrentFile() const { return current_index_; }
+
+  /** \brief Use the frame cache of each MDF file. */
+  void UseCache(bool use_cache) { use_cache_ = use_cache; }
+  [[nodiscard]] bool UseCache() const { return use_cache_; }
+
+  /** \brief Frames that are read from each file. */
+  [[nodiscard]] CanFrameFilter& Filter() { return filter_; }
+  [[nodiscard]] const CanFrameFilter& Filter() const { return filter_; }
+
+  /** \brief Replay speed relative to the original timestamps. */
+  void SpeedFactor(double speed_factor) { clock_.SpeedFactor(speed_factor); }
+  [[nodiscard]] double SpeedFactor() const { return clock_.SpeedFactor(); }
+
+  void Start() override;
+  void Stop() override;
+
+  void ReadConfig(const util::xml::IXmlNode& source_node) override;
+  void ToProperties(std::vector<BusProperty>& properties) const override;
+
+ protected:
+  void WriteProperties(util::xml::IXmlNode& source_node) const override;
+
+ private:
+  std::vector<PlaylistFile> file_list_;
+  bool use_cache_ = true;
+  CanFrameFilter filter_;
+
+  std::unique_ptr<MdfTrafficGenerator> current_;
+  std::atomic<size_t> current_index_ = 0;
+  size_t first_index_ = 0;  ///< First file that could be loaded.
+  std::unique_ptr<MdfTrafficGenerator> next_;  ///< Set by the prefetch job.
+  size_t next_index_ = 0;
+  BackgroundJob prefetch_job_;
+
+  ReplayClock clock_;
+  std::thread replay_thread_;
+  std::atomic<uint64_t> sent_frames_ = 0;
+  std::atomic<uint64_t> nof_stalls_ = 0;  ///< Prefetch not done in time.
+
+  [[nodiscard]] bool ScanFiles();
+  [[nodiscard]] std::unique_ptr<MdfTrafficGenerator> LoadFile(
+      size_t index, const BackgroundJob& job) const;
+  [[nodiscard]] bool LoadFirstFile();
+  void Prefetch(size_t index);
+  [[nodiscard]] bool NextFile();
+  void ReplayThread(bool rewind);
+};
+
+}  // namespace bus
@@ -5,38 +5,272 @@
 
 #pragma once
 
+#include <atomic>
 #include <deque>
 #include <memory>
+#include <thread>
+#include <vector>
 
 #include "bus/isource.h"
+#include "bus/canframefilter.h"
+#include "bus/canframestatistics.h"
+#include "bus/canframestore.h"
+#include "bus/compressedframestore.h"
+#include "bus/messagepool.h"
+#include "bus/replayclock.h"
 
 #include <mdf/canmessage.h>
-#include <bus/ibusmessage.h>
+
+namespace mdf {
+class MdfReader;
+class IDataGroup;
+class IChannelGroup;
+}
 
 namespace bus {
 
+class CanDataFrame;
+
+enum class TypeOfReplay : int {
+  RealTime = 0,  ///< Paced to the original timestamps.
+  Firehose = 1,  ///< As fast as possible.
+};
+
 class MdfTrafficGenerator : public ISource {
  public:
   MdfTrafficGenerator();
+  ~MdfTrafficGenerator() override;
   void Enable(bool enable) override;
   uint64_t FirstTime() const;
-  const IBusMessage* GetMessage(size_t index) const;
+  [[nodiscard]] uint64_t LastTime() const;
+  /** \brief Measurement start time (ns since 1970). */
+  [[nodiscard]] uint64_t StartTime() const { return start_time_; }
+  [[nodiscard]] CanFrameView GetMessage(size_t index) const;
+
+  size_t NofMessages() const {
+    return IsCompressed() ? compressed_store_.Size() : frame_store_.Size();
+  }
+
+  /** \brief Frames that are read from the file. Applied on enable. */
+  [[nodiscard]] CanFrameFilter& Filter() { return filter_; }
+  [[nodiscard]] const CanFrameFilter& Filter() const { return filter_; }
+
+  /** \brief Traffic summary that is computed when the file is read.
+   *
+   * The statistics are not computed in streaming mode.
+   */
+  [[nodiscard]] const CanFrameStatistics& Statistics() const {
+    return statistics_;
+  }
+
+  /** \brief Nominal bit rate (bit/s) used for the bus load. */
+  void BitRate(uint64_t bit_rate) { bit_rate_ = bit_rate; }
+  [[nodiscard]] uint64_t BitRate() const { return bit_rate_; }
+
+  /** \brief Use a memory mapped frame cache next to the MDF file. */
+  void UseCache(bool use_cache) { use_cache_ = use_cache; }
+  [[nodiscard]] bool UseCache() const { return use_cache_; }
+
+  /** \brief Keep the messages in a compressed store. Applied on enable.
+   *
+   * The compression is not used in streaming mode.
+   */
+  void Compress(bool compress) { compress_ = compress; }
+  [[nodiscard]] bool Compress() const { return compress_; }
+  [[nodiscard]] bool IsCompressed() const {
+    return !compressed_store_.Empty();
+  }
+
+  /** \brief Streaming mode only keeps a window of messages in memory. */
+  void Streaming(bool streaming) { streaming_ = streaming; }
+  [[nodiscard]] bool IsStreaming() const { return streaming_; }
+
+  /** \brief The replay thread is moving the streaming window.
+   *
+   * The messages of the window shall not be read by other threads while
+   * the replay is running.
+   */
+  [[nodiscard]] bool IsWindowReplaying() const {
+    return streaming_ && started_;
+  }
+
+  /** \brief Max number of messages in the streaming window. */
+  void WindowSize(size_t nof_messages);
+  [[nodiscard]] size_t WindowSize() const { return window_size_; }
+
+  /** \brief File index of the first message in the current window. */
+  [[nodiscard]] size_t WindowOffset() const { return window_offset_; }
+
+  [[nodiscard]] bool NextWindow();
+  [[nodiscard]] bool RewindWindow();
+  [[nodiscard]] bool IsLastWindow() const;
+
+  /** \brief Finds the first message at or after the time (ns since 1970).
+   *
+   * In streaming mode, the window that holds the message is read.
+   * @return Index of the message in the current window or NofMessages().
+   */
+  [[nodiscard]] size_t SeekTime(uint64_t time);
+
+  /** \brief Returns the message index range [first, last) in [from, to]. */
+  [[nodiscard]] std::pair<size_t, size_t> TimeRange(uint64_t from,
+                                                    uint64_t to) const {
+    return IsCompressed() ? compressed_store_.TimeRange(from, to)
+                          : frame_store_.TimeRange(from, to);
+  }
+
+  /** \brief Replay start time (ns since 1970). Zero is the file start. */
+  void ReplayStart(uint64_t time) { replay_start_ = time; }
+  [[nodiscard]] uint64_t ReplayStart() const { return replay_start_; }
+
+  /** \brief Replay speed relative to the original timestamps. */
+  void SpeedFactor(double speed_factor) { clock_.SpeedFactor(speed_factor); }
+  [[nodiscard]] double SpeedFactor() const { return clock_.SpeedFactor(); }
+
+  /** \brief Loop mode restarts the replay when it reaches the end. */
+  void Loop(bool loop) { loop_ = loop; }
+  [[nodiscard]] bool IsLoop() const { return loop_; }
+
+  /** \brief Time (ns) between the last and first frame in loop mode. */
+  void LoopGap(uint64_t gap) { loop_gap_ = gap; }
+  [[nodiscard]] uint64_t LoopGap() const { return loop_gap_; }
+  [[nodiscard]] uint64_t NofLoops() const { return nof_loops_; }
+
+  void ReplayMode(TypeOfReplay mode) { replay_mode_ = mode; }
+  [[nodiscard]] TypeOfReplay ReplayMode() const { return replay_mode_; }
+
+  /** \brief Number of frames published per batch in firehose mode. */
+  void BatchSize(size_t batch_size);
+  [[nodiscard]] size_t BatchSize() const { return batch_size_; }
+
+  /** \brief Publisher queue size that pauses the firehose replay. */
+  void MaxQueueSize(size_t max_size);
+  [[nodiscard]] size_t MaxQueueSize() const { return max_queue_size_; }
+
+  /** \brief Time offset (ns) added to the frames in a synchronized replay.
+   */
+  void TimeOffset(int64_t offset) { time_offset_ = offset; }
+  [[nodiscard]] int64_t TimeOffset() const { return time_offset_; }
+
+  /** \brief The replay is paced by a replay coordinator.
+   *
+   * The start doesn't start any replay thread. The coordinator publishes
+   * the frames instead.
+   */
+  void ExternalClock(bool external) { external_clock_ = external; }
+  [[nodiscard]] bool IsExternalClock() const { return external_clock_; }
+  [[nodiscard]] bool IsSynchronized() const override {
+    return external_clock_ && started_;
+  }
+  /** \brief Index of the first frame to replay after start. */
+  [[nodiscard]] size_t StartIndex() const { return start_index_; }
+  /** \brief Publishes a frame in the current window. */
+  void PublishFrame(size_t index, uint64_t send_time);
+
+  void Start() override;
+  void Stop() override;
+
+  void ReadConfig(const util::xml::IXmlNode& source_node) override;
+  void ToProperties(std::vector<BusProperty>& properties) const override;
+
+ protected:
+  void WriteProperties(util::xml::IXmlNode& source_node) const override;
 
-  size_t NofMessages() const { return message_list_.size(); }
  private:
+  /** \brief Read position of a CAN channel group in streaming mode.
+   *
+   * The frames that are read but not yet merged into a window are kept as
+   * candidates of the next window, so each sample is only read once.
+   */
+  struct StreamCursor {
+    mdf::IDataGroup* data_group = nullptr;
+    const mdf::IChannelGroup* channel_group = nullptr;
+    uint64_t next_sample = 0;  ///< First sample that isn't in a window.
+    uint64_t nof_samples = 0;
+    uint64_t read_sample = 0;  ///< Next sample to read from the file.
+    CanFrameStore frames;  ///< Candidate frames.
+    std::vector<uint64_t> samples;  ///< Sample index of each candidate.
+    size_t next_frame = 0;  ///< Next candidate to merge.
+
+    [[nodiscard]] bool HasCandidates() const {
+      return next_frame < samples.size();
+    }
+    /** \brief Returns the sample of the next frame to merge. */
+    [[nodiscard]] uint64_t Position() const {
+      return HasCandidates() ? samples[next_frame] : read_sample;
+    }
+    void ClearCandidates(uint64_t sample);
+  };
+
+  /** \brief Frames and statistics of one channel group. */
+  struct FrameStream {
+    CanFrameStore frames;
+    CanFrameStatistics statistics;
+  };
+
+  /** \brief Cursor positions at the start of a streaming window. */
+  struct WindowMark {
+    uint64_t first_time = 0;
+    size_t window_offset = 0;
+    std::vector<uint64_t> sample_list;
+  };
+
   uint64_t start_time_ = 0;
+  std::vector<mdf::BusType> bus_list_;  ///< Bus types in the file.
+  size_t nof_unsupported_groups_ = 0;
+  CanFrameStatistics statistics_;
+  uint64_t bit_rate_ = 500'000;
+  bool use_cache_ = true;
+  CanFrameFilter filter_;
+
+  bool streaming_ = false;
+  size_t window_size_ = 100'000;
+  size_t window_offset_ = 0;
+  std::unique_ptr<mdf::MdfReader> stream_reader_;
+  std::vector<StreamCursor> cursor_list_;
+  std::vector<WindowMark> window_mark_list_;
+
+  CanFrameStore frame_store_;
+  bool compress_ = false;
+  CompressedFrameStore compressed_store_;
 
+  ReplayClock clock_;
+  TypeOfReplay replay_mode_ = TypeOfReplay::RealTime;
+  size_t batch_size_ = 1'024;
+  size_t max_queue_size_ = 100'000;
+  uint64_t replay_start_ = 0;
+  int64_t time_offset_ = 0;
+  bool external_clock_ = false;
+  size_t start_index_ = 0;
+  bool loop_ = false;
+  uint64_t loop_gap_ = 1'000'000;
+  std::atomic<uint64_t> nof_loops_ = 0;
+  std::thread replay_thread_;
+  std::shared_ptr<MessagePool> message_pool_;  ///< Published messages.
+  MessageRing<CanDataFrame> data_frame_ring_;
 
-  std::deque<std::unique_ptr<IBusMessage>> message_list_;
+  std::atomic<uint64_t> sent_frames_ = 0;
+  std::atomic<uint64_t> sent_bytes_ = 0;
+  std::atomic<uint64_t> send_time_ = 0;  ///< Firehose duration in ns.
 
   [[nodiscard]] bool CheckMdfFile();
   [[nodiscard]] bool ReadMdfFile();
+  void CompressFrames();
+  void ReadDataGroup(mdf::MdfReader& reader, size_t dg_index,
+                     std::deque<FrameStream>& stream_list) const;
+  [[nodiscard]] bool IsTrafficGroup(
+      const mdf::IChannelGroup& channel_group) const;
+  [[nodiscard]] bool AddTrafficGroup(const mdf::IChannelGroup& channel_group);
+  [[nodiscard]] bool OpenStream();
+  [[nodiscard]] bool ReadWindow();
+  void ReadCandidates(StreamCursor& cursor);
+  void CloseStream();
+  void MarkWindow(std::vector<uint64_t> sample_list);
+  [[nodiscard]] bool NextReplayFrames(size_t& index, uint64_t& loop_offset);
+  void ReplayThread(size_t index);
+  void FirehoseThread(size_t index);
 
-  [[nodiscard]] bool CanMessageCallback(uint64_t sample,
-                                        const mdf::CanMessage& msg);
-  static bool LessTime(const std::unique_ptr<IBusMessage>& msg1,
-                          const std::unique_ptr<IBusMessage>& msg2);
-  void AddCanMessage(const mdf::CanMessage& msg);
+  bool AddCanMessage(const mdf::CanMessage& msg, CanFrameStore& store) const;
 };
 
 }  // namespace bus
@@ -0,0 +1,131 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace bus {
+
+/** \brief Thread-safe pool of fixed size memory blocks.
+ *
+ * The blocks are allocated in large chunks and freed blocks are kept in a
+ * free list. The chunks are released all at once when the pool is
+ * destroyed. Requests larger than the block size use the global heap.
+ */
+class MessagePool {
+ public:
+  static constexpr size_t kBlockSize = 256;
+  static constexpr size_t kBlocksPerChunk = 4'096;
+
+  MessagePool() = default;
+  MessagePool(const MessagePool&) = delete;
+  MessagePool& operator=(const MessagePool&) = delete;
+
+  [[nodiscard]] void* Allocate(size_t size);
+  void Deallocate(void* block, size_t size);
+
+  /** \brief Number of blocks in use. */
+  [[nodiscard]] size_t NofBlocks() const { return nof_blocks_; }
+  /** \brief Number of bytes allocated by the pool. */
+  [[nodiscard]] size_t MemorySize() const;
+
+ private:
+  struct FreeBlock {
+    FreeBlock* next = nullptr;
+  };
+
+  mutable std::mutex mutex_;
+  FreeBlock* free_list_ = nullptr;
+  std::vector<std::unique_ptr<std::byte[]>> chunk_list_;
+  std::atomic<size_t> nof_blocks_ = 0;
+};
+
+/** \brief Standard allocator that allocates from a message pool.
+ *
+ * The allocator shares the ownership of the pool, so messages that are
+ * still queued when the source releases its pool, stay valid.
+ */
+template <typename T>
+class PoolAllocator {
+ public:
+  using value_type = T;
+  static_assert(alignof(T) <= alignof(std::max_align_t));
+
+  explicit PoolAllocator(std::shared_ptr<MessagePool> pool)
+      : pool_(std::move(pool)) {}
+  template <typename U>
+  PoolAllocator(const PoolAllocator<U>& allocator)
+      : pool_(allocator.Pool()) {}
+
+  [[nodiscard]] T* allocate(size_t count) {
+    return static_cast<T*>(pool_->Allocate(count * sizeof(T)));
+  }
+  void deallocate(T* block, size_t count) {
+    pool_->Deallocate(block, count * sizeof(T));
+  }
+
+  [[nodiscard]] const std::shared_ptr<MessagePool>& Pool() const {
+    return pool_;
+  }
+
+  template <typename U>
+  bool operator==(const PoolAllocator<U>& allocator) const {
+    return pool_ == allocator.Pool();
+  }
+
+ private:
+  std::shared_ptr<MessagePool> pool_;
+};
+
+/** \brief Ring of message objects that are reused when released.
+ *
+ * A message is reused when the ring holds the only reference to it, so
+ * the broker and all subscribers are done with it. Otherwise a new message
+ * is created in the pool. The ring shall only be used by one thread at a
+ * time.
+ */
+template <typename T>
+class MessageRing {
+ public:
+  static constexpr size_t kRingSize = 8'192;
+
+  MessageRing() : ring_(kRingSize) {}
+
+  [[nodiscard]] std::shared_ptr<T> Next(
+      const std::shared_ptr<MessagePool>& pool) {
+    auto& slot = ring_[index_];
+    index_ = (index_ + 1) % ring_.size();
+    if (slot && slot.use_count() == 1) {
+      // Synchronizes with the release of the previous owners.
+      std::atomic_thread_fence(std::memory_order_acquire);
+      ++nof_reused_;
+      return slot;
+    }
+    slot = std::allocate_shared<T>(PoolAllocator<T>(pool));
+    return slot;
+  }
+
+  void Clear() {
+    std::ranges::fill(ring_, nullptr);
+    index_ = 0;
+    nof_reused_ = 0;
+  }
+
+  [[nodiscard]] uint64_t NofReused() const { return nof_reused_; }
+
+ private:
+  std::vector<std::shared_ptr<T>> ring_;
+  size_t index_ = 0;
+  std::atomic<uint64_t> nof_reused_ = 0;
+};
+
+}  // namespace bus
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <algorithm>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -15,12 +16,14 @@
 #include "bus/idatabase.h"
 #include "bus/isource.h"
 #include "bus/idestination.h"
+#include "bus/replaycoordinator.h"
 
 namespace bus {
 
 class Project {
 public:
   Project() = default;
+  ~Project();
 
   static bool IsProjectFile(const std::string& filename);
 
@@ -62,6 +65,33 @@ public:
   [[nodiscard]] const std::vector<std::unique_ptr<ISource>>& Sources() const;
   [[nodiscard]] std::vector<std::unique_ptr<ISource>>& Sources();
 
+  /** \brief All MDF sources are replayed against one master clock. */
+  void SynchronizedReplay(bool synchronized) {
+    synchronized_replay_ = synchronized;
+  }
+  [[nodiscard]] bool IsSynchronizedReplay() const {
+    return synchronized_replay_;
+  }
+
+  void StartSources();
+  void StopSources();
+
+  /** \brief The replay coordinator is reading the sources.
+   *
+   * The sources shall be stopped before any source is enabled, disabled or
+   * reconfigured.
+   */
+  [[nodiscard]] bool IsSynchronizedReplayRunning() const {
+    return coordinator_.IsRunning();
+  }
+
+  /** \brief Called in a job thread when a database or source is enabled. */
+  void EnableCallback(std::function<void()> callback) {
+    enable_callback_ = std::move(callback);
+  }
+  [[nodiscard]] bool IsEnabling() const;
+  void CancelEnable();
+
   IDestination* CreateDestination(TypeOfDestination type);
   IDestination* GetDestination(const std::string& name) const;
   void DeleteDestination(std::string name);
@@ -83,6 +113,9 @@ private:
   std::vector<std::unique_ptr<IDatabase>> databases_;
   std::vector<std::unique_ptr<ISource>> sources_;
   std::vector<std::unique_ptr<IDestination>> destinations_;
+  std::function<void()> enable_callback_;
+  bool synchronized_replay_ = false;
+  ReplayCoordinator coordinator_;
 
   void CheckEnvironmentPort(IEnvironment* new_env);
 };
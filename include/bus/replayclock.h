@@ -0,0 +1,80 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace bus {
+
+/** \brief Paces a replay against the original frame timestamps.
+ *
+ * The clock maps frame timestamps (ns since 1970) onto the steady clock,
+ * scaled by the speed factor. A wait sleeps until shortly before the
+ * target time and then spins, so the pacing isn't limited by the sleep
+ * resolution of the operating system. The lateness of each wait is
+ * measured as the replay jitter.
+ *
+ * The speed factor may be changed by another thread during a replay. The
+ * replay thread then moves the anchor to the current replay position, so
+ * the replay continues from there at the new speed.
+ */
+class ReplayClock {
+ public:
+  static constexpr double kMinSpeedFactor = 0.1;
+  static constexpr double kMaxSpeedFactor = 100.0;
+
+  void SpeedFactor(double speed_factor);
+  [[nodiscard]] double SpeedFactor() const { return speed_factor_; }
+
+  /** \brief Anchors the first frame time to the current time. */
+  void Start(uint64_t first_time);
+
+  /** \brief Moves the anchor to the current time but keeps a cancel. */
+  void Anchor(uint64_t first_time);
+
+  /** \brief Waits until the frame should be sent.
+   *
+   * @return False if the wait was cancelled.
+   */
+  [[nodiscard]] bool WaitUntil(uint64_t frame_time);
+
+  /** \brief Returns the time (ns since 1970) when the frame is sent. */
+  [[nodiscard]] uint64_t WallTime(uint64_t frame_time) const;
+
+  void Cancel();
+  [[nodiscard]] bool IsCancelled() const { return cancel_; }
+
+  [[nodiscard]] uint64_t NofFrames() const { return nof_frames_; }
+  [[nodiscard]] uint64_t MeanJitter() const;  ///< Mean jitter in ns.
+  [[nodiscard]] uint64_t MaxJitter() const { return max_jitter_; }
+
+ private:
+  std::atomic<double> speed_factor_ = 1.0;  ///< Set by the GUI thread.
+  double anchor_speed_factor_ = 1.0;  ///< Speed factor of the anchor.
+  uint64_t first_time_ = 0;
+  uint64_t start_wall_time_ = 0;
+  std::chrono::steady_clock::time_point start_clock_;
+
+  std::atomic<bool> cancel_ = false;
+  std::mutex wait_mutex_;
+  std::condition_variable wait_condition_;
+
+  std::atomic<uint64_t> nof_frames_ = 0;
+  std::atomic<uint64_t> sum_jitter_ = 0;
+  std::atomic<uint64_t> max_jitter_ = 0;
+
+  [[nodiscard]] bool IsSpeedChanged() const {
+    return speed_factor_ != anchor_speed_factor_;
+  }
+  void ChangeSpeed();
+  [[nodiscard]] std::chrono::nanoseconds Elapsed(uint64_t frame_time) const;
+};
+
+}  // namespace bus
@@ -0,0 +1,63 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "bus/busproperty.h"
+#include "bus/replayclock.h"
+
+namespace bus {
+
+class MdfTrafficGenerator;
+
+/** \brief Replays several traffic sources against one master clock.
+ *
+ * The coordinator merges the frames of all sources into one time-ordered
+ * output. Each source time is shifted by its time offset. Frames with
+ * equal times are sent in source order. The frames are read directly from
+ * the source frame stores and each source publishes its own frames.
+ *
+ * The sources shall be started with an external clock before the
+ * coordinator is started.
+ */
+class ReplayCoordinator {
+ public:
+  ReplayCoordinator() = default;
+  ~ReplayCoordinator();
+  ReplayCoordinator(const ReplayCoordinator&) = delete;
+  ReplayCoordinator& operator=(const ReplayCoordinator&) = delete;
+
+  void AddSource(MdfTrafficGenerator& source);
+  void Clear();
+  [[nodiscard]] size_t NofSources() const { return source_list_.size(); }
+
+  void SpeedFactor(double speed_factor) { clock_.SpeedFactor(speed_factor); }
+  [[nodiscard]] double SpeedFactor() const { return clock_.SpeedFactor(); }
+
+  void Start();
+  void Stop();
+  [[nodiscard]] bool IsRunning() const { return thread_.joinable(); }
+
+  void ToProperties(std::vector<BusProperty>& properties) const;
+
+ private:
+  struct SourceCursor {
+    MdfTrafficGenerator* source = nullptr;
+    size_t index = 0;  ///< Next frame in the source window.
+  };
+
+  std::vector<SourceCursor> source_list_;
+  ReplayClock clock_;
+  std::thread thread_;
+
+  [[nodiscard]] static uint64_t FrameTime(const SourceCursor& cursor);
+  void ReplayThread();
+};
+
+}  // namespace bus
@@ -0,0 +1,124 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <dbc/dbcfile.h>
+
+#include "bus/canframestore.h"
+#include "bus/dbmetric.h"
+
+namespace bus {
+
+/** \brief Precompiled extraction of one signal from a CAN frame.
+ *
+ * The signals are classified when the plan is built. Byte aligned signals
+ * of 8, 16, 32 or 64 bits are loaded directly, other signals within one
+ * 64-bit word are loaded, shifted and masked. Signals that don't fit in
+ * one 64-bit load, are extracted bit by bit.
+ */
+struct SignalDecodeOp {
+  enum class Kernel : uint8_t {
+    Aligned8,
+    AlignedLittle16,
+    AlignedLittle32,
+    AlignedLittle64,
+    AlignedBig16,
+    AlignedBig32,
+    AlignedBig64,
+    WordLittle,
+    WordBig,
+    Generic
+  };
+
+  enum class ValueType : uint8_t {
+    Unsigned,
+    Signed,
+    Float,
+    Double
+  };
+
+  uint16_t byte_offset = 0;  ///< First byte of the 64-bit load.
+  uint16_t nof_bytes = 0;  ///< Frame length needed for the signal.
+  uint16_t start_bit = 0;  ///< LSB position, only used by the generic path.
+  uint8_t shift = 0;  ///< Right shift of the loaded word.
+  uint8_t bit_length = 0;
+  bool little_endian = true;
+  Kernel kernel = Kernel::Generic;
+  ValueType value_type = ValueType::Unsigned;
+  bool multiplexed = false;  ///< Only valid for one multiplexor value.
+  uint64_t mask = 0;
+  uint64_t mux_value = 0;
+  double scale = 1.0;
+  double offset = 0.0;
+  DbMetric* metric = nullptr;  ///< Target metric slot.
+};
+
+/** \brief Decodes the signals of CAN data frames into DB metrics.
+ *
+ * The decode plans are built when the database is enabled. The decoding
+ * is one hash lookup of the message ID followed by a loop over the
+ * plan without string lookups or allocations.
+ */
+class SignalDecoder {
+ public:
+  void Clear();
+
+  /** \brief Adds a signal of a DBC message to the plan of the message.
+   *
+   * The message ID shall include the extended ID flag (bit 31) in the same
+   * way as the DBC file.
+   */
+  void AddSignal(uint32_t message_id, const dbc::Signal& signal,
+                 DbMetric& metric);
+
+  /** \brief Decodes a frame. Returns false if the ID has no plan. */
+  bool Decode(uint32_t message_id, uint64_t timestamp,
+              std::span<const uint8_t> data) const;
+
+  /** \brief Decodes frames of one message ID into one column per signal.
+   *
+   * The columns are in plan order. The metric values aren't updated.
+   * Returns false if the ID has no plan.
+   */
+  bool DecodeBatch(uint32_t message_id, std::span<const CanFrameView> frames,
+                   std::vector<SignalColumn>& columns) const;
+
+  /** \brief Converts batch columns with SIMD if the build target has it.
+   *
+   * It is on by default. Turning it off gives the scalar conversion, which
+   * the vector conversion shall match.
+   */
+  void Vectorize(bool vectorize) { vectorize_ = vectorize; }
+  [[nodiscard]] bool Vectorize() const { return vectorize_; }
+
+  [[nodiscard]] bool Empty() const { return plan_list_.empty(); }
+  [[nodiscard]] size_t NofPlans() const { return plan_list_.size(); }
+  [[nodiscard]] size_t NofSignals() const { return nof_signals_; }
+
+  [[nodiscard]] static uint64_t ExtractRaw(const SignalDecodeOp& op,
+                                           std::span<const uint8_t> data);
+  [[nodiscard]] static double ToValue(const SignalDecodeOp& op,
+                                      uint64_t raw);
+ private:
+  struct DecodePlan {
+    bool has_multiplexor = false;
+    SignalDecodeOp multiplexor;
+    std::vector<SignalDecodeOp> op_list;
+  };
+
+  std::unordered_map<uint32_t, DecodePlan> plan_list_;
+  size_t nof_signals_ = 0;
+  bool vectorize_ = true;
+
+  static SignalDecodeOp MakeOp(const dbc::Signal& signal);
+};
+
+}  // namespace bus
@@ -0,0 +1,72 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#include "bus/backgroundjob.h"
+
+#include <algorithm>
+#include <exception>
+
+#include <util/logstream.h>
+
+using namespace util::log;
+
+namespace bus {
+
+BackgroundJob::~BackgroundJob() {
+  Cancel();
+  Wait();
+}
+
+void BackgroundJob::Start(JobFunction job, DoneFunction done) {
+  std::lock_guard lock(thread_mutex_);
+  cancel_ = true;
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  cancel_ = false;
+  done_ = 0;
+  total_ = 0;
+  running_ = true;
+  thread_ = std::thread([this, job = std::move(job),
+                         done = std::move(done)] () {
+    bool result = false;
+    try {
+      result = job ? job() : false;
+    } catch (const std::exception& err) {
+      LOG_ERROR() << "Background job failed. Error: " << err.what();
+    }
+    running_ = false;
+    if (done) {
+      done(result);
+    }
+  });
+}
+
+void BackgroundJob::Cancel() {
+  cancel_ = true;
+}
+
+void BackgroundJob::Wait() {
+  std::lock_guard lock(thread_mutex_);
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void BackgroundJob::Progress(uint64_t done, uint64_t total) {
+  total_ = total;
+  done_ = done;
+}
+
+double BackgroundJob::Progress() const {
+  const uint64_t total = total_;
+  if (total == 0) {
+    return running_ ? 0.0 : 1.0;
+  }
+  return std::min(static_cast<double>(done_) / static_cast<double>(total),
+                  1.0);
+}
+
+}  // namespace bus
@@ -67,4 +67,11 @@ void BrokerEnvironment::Stop() {
   started_ = false;
 }
 
+std::shared_ptr<IBusMessageQueue> BrokerEnvironment::CreatePublisher() {
+  if (!broker_ || !started_) {
+    return {};
+  }
+  return broker_->CreatePublisher();
+}
+
 }  // namespace bus
\ No newline at end of file
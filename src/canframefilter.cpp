@@ -0,0 +1,209 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#include "bus/canframefilter.h"
+
+#include <bit>
+#include <sstream>
+
+#include <util/ixmlnode.h>
+#include <util/logstream.h>
+
+using namespace util::log;
+using namespace util::xml;
+
+namespace {
+
+constexpr uint64_t kFnvOffset = 14'695'981'039'346'656'037ULL;
+constexpr uint64_t kFnvPrime = 1'099'511'628'211ULL;
+
+void HashValue(uint64_t& hash, uint64_t value) {
+  for (int byte = 0; byte < 8; ++byte) {
+    hash ^= (value >> (byte * 8)) & 0xFF;
+    hash *= kFnvPrime;
+  }
+}
+
+/** \brief Parses a space separated list of numbers. */
+std::vector<uint32_t> ParseList(const std::string& text, bool hex) {
+  std::vector<uint32_t> list;
+  std::istringstream input(text);
+  if (hex) {
+    input >> std::hex;
+  }
+  uint32_t value = 0;
+  while (input >> value) {
+    list.push_back(value);
+  }
+  return list;
+}
+
+template <typename T>
+std::string FormatList(const std::vector<T>& list, bool hex) {
+  std::ostringstream output;
+  if (hex) {
+    output << std::hex << std::uppercase;
+  }
+  for (const auto value : list) {
+    if (!output.str().empty()) {
+      output << " ";
+    }
+    output << static_cast<uint32_t>(value);
+  }
+  return output.str();
+}
+
+}  // namespace
+
+namespace bus {
+
+void CanFrameFilter::Clear() {
+  channel_list_.clear();
+  standard_id_bits_.reset();
+  extended_id_set_.clear();
+  id_filter_ = false;
+  time_window_ = false;
+  from_time_ = 0.0;
+  to_time_ = 0.0;
+}
+
+bool CanFrameFilter::IsActive() const {
+  return !channel_list_.empty() || id_filter_ || time_window_;
+}
+
+void CanFrameFilter::AddChannel(uint16_t channel) {
+  const auto itr = std::ranges::lower_bound(channel_list_, channel);
+  if (itr == channel_list_.end() || *itr != channel) {
+    channel_list_.insert(itr, channel);
+  }
+}
+
+bool CanFrameFilter::AddId(uint32_t can_id, bool extended) {
+  if (extended) {
+    can_id &= 0x7FFFFFFF;
+    if (can_id > kMaxExtendedId) {
+      return false;
+    }
+    extended_id_set_.insert(can_id);
+  } else {
+    if (can_id >= kNofStandardIds) {
+      return false;
+    }
+    standard_id_bits_.set(can_id);
+  }
+  id_filter_ = true;
+  return true;
+}
+
+void CanFrameFilter::TimeWindow(double from_time, double to_time) {
+  from_time_ = std::min(from_time, to_time);
+  to_time_ = std::max(from_time, to_time);
+  time_window_ = true;
+}
+
+uint64_t CanFrameFilter::Hash() const {
+  if (!IsActive()) {
+    return 0;
+  }
+  uint64_t hash = kFnvOffset;
+  for (const uint16_t channel : channel_list_) {
+    HashValue(hash, channel);
+  }
+  HashValue(hash, 0xFFFF'FFFF);
+  for (size_t can_id = 0; can_id < kNofStandardIds; ++can_id) {
+    if (standard_id_bits_.test(can_id)) {
+      HashValue(hash, can_id);
+    }
+  }
+  HashValue(hash, 0xFFFF'FFFF);
+  std::vector<uint32_t> extended_list(extended_id_set_.cbegin(),
+                                      extended_id_set_.cend());
+  std::ranges::sort(extended_list);
+  for (const uint32_t can_id : extended_list) {
+    HashValue(hash, can_id);
+  }
+  if (time_window_) {
+    HashValue(hash, std::bit_cast<uint64_t>(from_time_));
+    HashValue(hash, std::bit_cast<uint64_t>(to_time_));
+  }
+  return hash;
+}
+
+void CanFrameFilter::ReadConfig(const IXmlNode& source_node) {
+  Clear();
+  const auto* filter_node = source_node.GetNode("Filter");
+  if (filter_node == nullptr) {
+    return;
+  }
+  const auto channels = filter_node->Property<std::string>("Channels");
+  for (const uint32_t channel : ParseList(channels, false)) {
+    AddChannel(static_cast<uint16_t>(channel));
+  }
+  const auto standard_ids = filter_node->Property<std::string>("StandardIds");
+  for (const uint32_t can_id : ParseList(standard_ids, true)) {
+    if (!AddId(can_id, false)) {
+      LOG_ERROR() << "Invalid 11-bit CAN ID in the filter. ID: " << std::hex
+                  << can_id;
+    }
+  }
+  const auto extended_ids = filter_node->Property<std::string>("ExtendedIds");
+  for (const uint32_t can_id : ParseList(extended_ids, true)) {
+    if (!AddId(can_id, true)) {
+      LOG_ERROR() << "Invalid 29-bit CAN ID in the filter. ID: " << std::hex
+                  << can_id;
+    }
+  }
+  if (filter_node->Property<bool>("TimeWindow", false)) {
+    TimeWindow(filter_node->Property<double>("FromTime", 0.0),
+               filter_node->Property<double>("ToTime", 0.0));
+  }
+}
+
+void CanFrameFilter::WriteConfig(IXmlNode& source_node) const {
+  if (!IsActive()) {
+    return;
+  }
+  auto& filter_node = source_node.AddNode("Filter");
+  filter_node.SetProperty("Channels", FormatList(channel_list_, false));
+
+  std::vector<uint32_t> standard_list;
+  for (uint32_t can_id = 0; can_id < kNofStandardIds; ++can_id) {
+    if (standard_id_bits_.test(can_id)) {
+      standard_list.push_back(can_id);
+    }
+  }
+  filter_node.SetProperty("StandardIds", FormatList(standard_list, true));
+
+  std::vector<uint32_t> extended_list(extended_id_set_.cbegin(),
+                                      extended_id_set_.cend());
+  std::ranges::sort(extended_list);
+  filter_node.SetProperty("ExtendedIds", FormatList(extended_list, true));
+
+  filter_node.SetProperty("TimeWindow", time_window_);
+  filter_node.SetProperty("FromTime", from_time_);
+  filter_node.SetProperty("ToTime", to_time_);
+}
+
+void CanFrameFilter::ToProperties(std::vector<BusProperty>& properties) const {
+  properties.emplace_back();
+  properties.emplace_back("Filter");
+  properties.emplace_back("Channels", channel_list_.empty() ?
+                          std::string("All") :
+                          FormatList(channel_list_, false));
+  if (id_filter_) {
+    properties.emplace_back("Standard IDs",
+                            std::to_string(NofStandardIds()));
+    properties.emplace_back("Extended IDs",
+                            std::to_string(NofExtendedIds()));
+  } else {
+    properties.emplace_back("IDs", "All");
+  }
+  if (time_window_) {
+    properties.emplace_back("From Time", std::to_string(from_time_), "s");
+    properties.emplace_back("To Time", std::to_string(to_time_), "s");
+  }
+}
+
+}  // namespace bus
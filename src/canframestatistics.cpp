@@ -0,0 +1,241 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#include "bus/canframestatistics.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <tuple>
+
+namespace {
+
+// Nominal frame length including the inter-frame space but without the
+// data bytes and stuff bits.
+constexpr uint64_t kStandardFrameBits = 47;
+constexpr uint64_t kExtendedFrameBits = 67;
+constexpr uint64_t kErrorFrameBits = 17;
+
+constexpr size_t kMaxIdProperties = 256;
+
+uint64_t IdKey(uint16_t channel, uint32_t message_id) {
+  return (static_cast<uint64_t>(channel) << 32) | message_id;
+}
+
+uint64_t FrameBits(const bus::CanFrameView& frame) {
+  using namespace bus;
+  switch (frame.Type()) {
+    case CanFrameType::ErrorFrame:
+    case CanFrameType::OverloadFrame:
+      return kErrorFrameBits;
+
+    case CanFrameType::RemoteFrame:
+      return frame.ExtendedId() ? kExtendedFrameBits : kStandardFrameBits;
+
+    default:
+      break;
+  }
+  return (frame.ExtendedId() ? kExtendedFrameBits : kStandardFrameBits)
+         + 8 * frame.DataLength();
+}
+
+std::string FormatMs(uint64_t ns) {
+  std::ostringstream text;
+  text << std::fixed << std::setprecision(3)
+       << static_cast<double>(ns) / 1'000'000;
+  return text.str();
+}
+
+}  // namespace
+
+namespace bus {
+
+uint64_t CanFrameStatistics::IdStatistics::AvgPeriod() const {
+  return nof_frames > 1 ? (last_time - first_time) / (nof_frames - 1) : 0;
+}
+
+void CanFrameStatistics::Clear() {
+  id_map_.clear();
+  channel_bits_.clear();
+  dlc_count_ = {};
+  nof_frames_ = 0;
+  nof_error_frames_ = 0;
+  first_time_ = 0;
+  last_time_ = 0;
+}
+
+void CanFrameStatistics::Add(const CanFrameView& frame) {
+  const uint64_t time = frame.Timestamp();
+  if (nof_frames_ == 0 || time < first_time_) {
+    first_time_ = time;
+  }
+  if (nof_frames_ == 0 || time > last_time_) {
+    last_time_ = time;
+  }
+  ++nof_frames_;
+  channel_bits_[frame.BusChannel()] += FrameBits(frame);
+
+  const CanFrameType type = frame.Type();
+  if (type == CanFrameType::ErrorFrame) {
+    ++nof_error_frames_;
+  }
+  if (type == CanFrameType::ErrorFrame ||
+      type == CanFrameType::OverloadFrame) {
+    return;
+  }
+  ++dlc_count_[frame.Dlc() & 0x0F];
+
+  auto& id = id_map_[IdKey(frame.BusChannel(), frame.MessageId())];
+  if (id.nof_frames == 0) {
+    id.channel = frame.BusChannel();
+    id.message_id = frame.MessageId();
+    id.first_time = time;
+  } else if (time >= id.last_time) {
+    const uint64_t period = time - id.last_time;
+    id.min_period = std::min(id.min_period, period);
+    id.max_period = std::max(id.max_period, period);
+  }
+  id.last_time = std::max(id.last_time, time);
+  ++id.nof_frames;
+}
+
+bool CanFrameStatistics::Merge(const CanFrameStatistics& statistics) {
+  if (statistics.Empty()) {
+    return true;
+  }
+  first_time_ = Empty() ? statistics.first_time_ :
+      std::min(first_time_, statistics.first_time_);
+  last_time_ = std::max(last_time_, statistics.last_time_);
+  nof_frames_ += statistics.nof_frames_;
+  nof_error_frames_ += statistics.nof_error_frames_;
+  for (size_t dlc = 0; dlc < dlc_count_.size(); ++dlc) {
+    dlc_count_[dlc] += statistics.dlc_count_[dlc];
+  }
+  for (const auto& [channel, bits] : statistics.channel_bits_) {
+    channel_bits_[channel] += bits;
+  }
+  bool exact = true;
+  for (const auto& [key, source] : statistics.id_map_) {
+    auto [itr, inserted] = id_map_.try_emplace(key, source);
+    if (inserted) {
+      continue;
+    }
+    auto& id = itr->second;
+    if (source.first_time < id.last_time && id.first_time < source.last_time) {
+      exact = false;
+    } else {
+      const uint64_t gap = source.first_time >= id.last_time ?
+          source.first_time - id.last_time : id.first_time - source.last_time;
+      id.min_period = std::min(id.min_period, gap);
+      id.max_period = std::max(id.max_period, gap);
+    }
+    id.nof_frames += source.nof_frames;
+    id.first_time = std::min(id.first_time, source.first_time);
+    id.last_time = std::max(id.last_time, source.last_time);
+    id.min_period = std::min(id.min_period, source.min_period);
+    id.max_period = std::max(id.max_period, source.max_period);
+  }
+  return exact;
+}
+
+void CanFrameStatistics::Compute(const CanFrameStore& store) {
+  Clear();
+  for (size_t index = 0; index < store.Size(); ++index) {
+    Add(store.At(index));
+  }
+}
+
+std::vector<CanFrameStatistics::IdStatistics>
+CanFrameStatistics::IdList() const {
+  std::vector<IdStatistics> id_list;
+  id_list.reserve(id_map_.size());
+  for (const auto& [key, id] : id_map_) {
+    id_list.push_back(id);
+  }
+  std::ranges::sort(id_list, [] (const IdStatistics& id1,
+                                 const IdStatistics& id2) -> bool {
+    return std::tie(id1.channel, id1.message_id) <
+           std::tie(id2.channel, id2.message_id);
+  });
+  return id_list;
+}
+
+double CanFrameStatistics::BusLoad(uint16_t channel,
+                                   uint64_t bit_rate) const {
+  const auto itr = channel_bits_.find(channel);
+  const uint64_t span = last_time_ - first_time_;
+  if (itr == channel_bits_.cend() || span == 0 || bit_rate == 0) {
+    return 0.0;
+  }
+  const double seconds = static_cast<double>(span) / 1'000'000'000;
+  return static_cast<double>(itr->second) /
+         (seconds * static_cast<double>(bit_rate));
+}
+
+void CanFrameStatistics::ToProperties(std::vector<BusProperty>& properties,
+                                      uint64_t bit_rate) const {
+  properties.emplace_back();
+  properties.emplace_back("Statistics");
+  const double span = static_cast<double>(last_time_ - first_time_)
+                      / 1'000'000'000;
+  properties.emplace_back("Time Span", std::to_string(span), "s");
+  properties.emplace_back("Frames", std::to_string(nof_frames_));
+  if (span > 0.0) {
+    const auto rate = static_cast<uint64_t>(
+        static_cast<double>(nof_frames_) / span);
+    properties.emplace_back("Frame Rate", std::to_string(rate), "frames/s");
+  }
+  if (nof_error_frames_ > 0) {
+    properties.emplace_back("Error Frames",
+                            std::to_string(nof_error_frames_));
+  }
+  for (const auto& [channel, bits] : channel_bits_) {
+    properties.emplace_back("Bus Load CH" + std::to_string(channel),
+                            std::to_string(BusLoad(channel, bit_rate) * 100),
+                            "%");
+  }
+  std::ostringstream dlc_text;
+  for (size_t dlc = 0; dlc < dlc_count_.size(); ++dlc) {
+    if (dlc_count_[dlc] == 0) {
+      continue;
+    }
+    if (!dlc_text.str().empty()) {
+      dlc_text << ", ";
+    }
+    dlc_text << dlc << ": " << dlc_count_[dlc];
+  }
+  properties.emplace_back("DLC Count", dlc_text.str());
+
+  const auto id_list = IdList();
+  properties.emplace_back("IDs", std::to_string(id_list.size()));
+  if (id_list.empty()) {
+    return;
+  }
+  properties.emplace_back();
+  properties.emplace_back("ID Statistics");
+  for (size_t index = 0; index < id_list.size(); ++index) {
+    if (index >= kMaxIdProperties) {
+      properties.emplace_back("More IDs",
+                              std::to_string(id_list.size() - index));
+      break;
+    }
+    const auto& id = id_list[index];
+    const bool extended = (id.message_id & 0x80000000) != 0;
+    std::ostringstream label;
+    label << "CH" << id.channel << " " << std::hex << std::uppercase
+          << std::setfill('0') << std::setw(extended ? 8 : 3)
+          << (id.message_id & 0x1FFFFFFF);
+    std::ostringstream value;
+    value << id.nof_frames << " frames";
+    if (id.nof_frames > 1) {
+      value << ", " << FormatMs(id.AvgPeriod()) << " ms ("
+            << FormatMs(id.min_period) << "-" << FormatMs(id.max_period)
+            << " ms)";
+    }
+    properties.emplace_back(label.str(), value.str());
+  }
+}
+
+}  // namespace bus
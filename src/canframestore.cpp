@@ -0,0 +1,293 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#include "bus/canframestore.h"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <queue>
+#include <tuple>
+
+namespace {
+
+constexpr int kRadixBits = 16;
+constexpr size_t kRadixSize = size_t{1} << kRadixBits;
+constexpr uint64_t kRadixMask = kRadixSize - 1;
+
+/** \brief Size of the bit position prefix of an error frame. */
+constexpr size_t kErrorPrefixSize = 2;
+
+bool IsErrorFrame(uint16_t flags) {
+  return (flags & bus::CanFrameFlag::FrameTypeMask) ==
+      static_cast<uint16_t>(bus::CanFrameType::ErrorFrame) << 10;
+}
+
+template <typename T>
+size_t ColumnSize(const std::vector<T>& column) {
+  return column.capacity() * sizeof(T);
+}
+
+template <typename T>
+void CopyColumn(std::span<const T> source, std::vector<T>& dest) {
+  dest.assign(source.begin(), source.end());
+}
+
+}  // namespace
+
+namespace bus {
+
+CanFrameView::CanFrameView(uint64_t timestamp, uint32_t message_id,
+                           uint16_t channel, uint8_t dlc, uint16_t flags,
+                           std::span<const uint8_t> data,
+                           uint16_t bit_position)
+    : timestamp_(timestamp),
+      message_id_(message_id),
+      channel_(channel),
+      dlc_(dlc),
+      flags_(flags),
+      bit_position_(bit_position),
+      data_(data) {}
+
+CanFrameStore::CanFrameStore() {
+  offsets_.push_back(0);
+}
+
+void CanFrameStore::Clear() {
+  mapped_.reset();
+  timestamps_.clear();
+  message_ids_.clear();
+  channels_.clear();
+  dlcs_.clear();
+  flags_.clear();
+  offsets_.clear();
+  payload_.clear();
+  time_index_.clear();
+  offsets_.push_back(0);
+}
+
+void CanFrameStore::Reserve(size_t nof_frames, size_t nof_bytes) {
+  Detach();
+  timestamps_.reserve(nof_frames);
+  message_ids_.reserve(nof_frames);
+  channels_.reserve(nof_frames);
+  dlcs_.reserve(nof_frames);
+  flags_.reserve(nof_frames);
+  offsets_.reserve(nof_frames + 1);
+  payload_.reserve(nof_bytes);
+  time_index_.reserve(nof_frames / kTimeIndexStep + 1);
+}
+
+void CanFrameStore::ShrinkToFit() {
+  timestamps_.shrink_to_fit();
+  message_ids_.shrink_to_fit();
+  channels_.shrink_to_fit();
+  dlcs_.shrink_to_fit();
+  flags_.shrink_to_fit();
+  offsets_.shrink_to_fit();
+  payload_.shrink_to_fit();
+  time_index_.shrink_to_fit();
+}
+
+void CanFrameStore::Add(uint64_t timestamp, uint32_t message_id,
+                        uint16_t channel, uint8_t dlc, uint16_t flags,
+                        std::span<const uint8_t> data,
+                        uint16_t bit_position) {
+  Detach();
+  if (timestamps_.size() % kTimeIndexStep == 0) {
+    time_index_.push_back(timestamp);
+  }
+  timestamps_.push_back(timestamp);
+  message_ids_.push_back(message_id);
+  channels_.push_back(channel);
+  dlcs_.push_back(dlc);
+  flags_.push_back(flags);
+  if (IsErrorFrame(flags)) {
+    payload_.push_back(static_cast<uint8_t>(bit_position & 0xFF));
+    payload_.push_back(static_cast<uint8_t>(bit_position >> 8));
+  }
+  payload_.insert(payload_.end(), data.begin(), data.end());
+  offsets_.push_back(payload_.size());
+}
+
+void CanFrameStore::Add(const CanFrameView& frame) {
+  Add(frame.Timestamp(), frame.MessageId(), frame.BusChannel(), frame.Dlc(),
+      frame.Flags(), frame.DataBytes(), frame.BitPosition());
+}
+
+CanFrameView CanFrameStore::At(size_t index) const {
+  if (index >= Size()) {
+    return {};
+  }
+  const auto offsets = OffsetColumn();
+  const uint64_t offset = offsets[index];
+  auto data = PayloadColumn().subspan(offset, offsets[index + 1] - offset);
+  const uint16_t flags = FlagColumn()[index];
+  uint16_t bit_position = 0;
+  if (IsErrorFrame(flags) && data.size() >= kErrorPrefixSize) {
+    bit_position = static_cast<uint16_t>(data[0] | (data[1] << 8));
+    data = data.subspan(kErrorPrefixSize);
+  }
+  return {TimestampColumn()[index], MessageIdColumn()[index],
+          ChannelColumn()[index], DlcColumn()[index], flags, data,
+          bit_position};
+}
+
+void CanFrameStore::Attach(std::shared_ptr<const MappedColumns> mapped) {
+  Clear();
+  mapped_ = std::move(mapped);
+}
+
+void CanFrameStore::Detach() {
+  if (!mapped_) {
+    return;
+  }
+  const auto mapped = std::move(mapped_);
+  CopyColumn(mapped->timestamps, timestamps_);
+  CopyColumn(mapped->message_ids, message_ids_);
+  CopyColumn(mapped->channels, channels_);
+  CopyColumn(mapped->dlcs, dlcs_);
+  CopyColumn(mapped->flags, flags_);
+  CopyColumn(mapped->offsets, offsets_);
+  CopyColumn(mapped->payload, payload_);
+  CopyColumn(mapped->time_index, time_index_);
+}
+
+size_t CanFrameStore::MemorySize() const {
+  if (mapped_) {
+    return TimestampColumn().size_bytes() + MessageIdColumn().size_bytes()
+           + ChannelColumn().size_bytes() + DlcColumn().size_bytes()
+           + FlagColumn().size_bytes() + OffsetColumn().size_bytes()
+           + PayloadColumn().size_bytes() + TimeIndexColumn().size_bytes();
+  }
+  return ColumnSize(timestamps_) + ColumnSize(message_ids_)
+         + ColumnSize(channels_) + ColumnSize(dlcs_) + ColumnSize(flags_)
+         + ColumnSize(offsets_) + ColumnSize(payload_)
+         + ColumnSize(time_index_);
+}
+
+bool CanFrameStore::IsSorted() const {
+  return std::ranges::is_sorted(TimestampColumn());
+}
+
+/**
+ * @brief Sorts the frames by timestamp.
+ *
+ * The sort is a stable LSD radix sort on the 64-bit timestamps using
+ * 16-bit digits. Digits that are equal for all frames, typically the
+ * upper bits, are skipped.
+ */
+void CanFrameStore::SortByTime() {
+  if (IsSorted()) {
+    return;
+  }
+  const size_t nof_frames = Size();
+  std::vector<size_t> order(nof_frames);
+  std::iota(order.begin(), order.end(), 0);
+  std::vector<size_t> temp(nof_frames);
+  std::vector<size_t> count(kRadixSize);
+  const auto timestamps = TimestampColumn();
+
+  for (int shift = 0; shift < 64; shift += kRadixBits) {
+    std::ranges::fill(count, 0);
+    for (const uint64_t timestamp : timestamps) {
+      ++count[(timestamp >> shift) & kRadixMask];
+    }
+    if (std::ranges::any_of(count, [&] (size_t digit_count) -> bool {
+          return digit_count == nof_frames;
+        })) {
+      continue;
+    }
+    size_t position = 0;
+    for (auto& digit_count : count) {
+      const size_t temp_count = digit_count;
+      digit_count = position;
+      position += temp_count;
+    }
+    for (const size_t index : order) {
+      const auto digit = (timestamps[index] >> shift) & kRadixMask;
+      temp[count[digit]++] = index;
+    }
+    order.swap(temp);
+  }
+
+  CanFrameStore sorted;
+  sorted.Reserve(nof_frames, PayloadColumn().size());
+  for (const size_t index : order) {
+    sorted.Add(At(index));
+  }
+  *this = std::move(sorted);
+}
+
+size_t CanFrameStore::LowerBound(uint64_t time) const {
+  // The index entry N is the timestamp of frame N * kTimeIndexStep. The
+  // first entry at or after the time, limits the search to one block.
+  const auto time_index = TimeIndexColumn();
+  const auto itr = std::ranges::lower_bound(time_index, time);
+  const auto block = static_cast<size_t>(itr - time_index.begin());
+  const size_t first = block == 0 ? 0 : (block - 1) * kTimeIndexStep;
+  const size_t last = block < time_index.size() ?
+      block * kTimeIndexStep : Size();
+  const auto begin = TimestampColumn().begin();
+  return static_cast<size_t>(
+      std::lower_bound(begin + first, begin + last, time) - begin);
+}
+
+size_t CanFrameStore::UpperBound(uint64_t time) const {
+  const auto time_index = TimeIndexColumn();
+  const auto itr = std::ranges::upper_bound(time_index, time);
+  const auto block = static_cast<size_t>(itr - time_index.begin());
+  const size_t first = block == 0 ? 0 : (block - 1) * kTimeIndexStep;
+  const size_t last = block < time_index.size() ?
+      block * kTimeIndexStep : Size();
+  const auto begin = TimestampColumn().begin();
+  return static_cast<size_t>(
+      std::upper_bound(begin + first, begin + last, time) - begin);
+}
+
+std::pair<size_t, size_t> CanFrameStore::TimeRange(uint64_t from,
+                                                   uint64_t to) const {
+  if (from > to) {
+    return {0, 0};
+  }
+  return {LowerBound(from), UpperBound(to)};
+}
+
+void CanFrameStore::Merge(const std::vector<CanFrameStore*>& stream_list) {
+  Clear();
+  size_t nof_frames = 0;
+  size_t nof_bytes = 0;
+  for (auto* stream : stream_list) {
+    if (stream == nullptr) {
+      continue;
+    }
+    stream->SortByTime();
+    nof_frames += stream->Size();
+    nof_bytes += stream->PayloadColumn().size();
+  }
+  Reserve(nof_frames, nof_bytes);
+
+  // The heap holds the next frame of each stream. The stream index is used
+  // as tie-breaker, so the merge is deterministic.
+  using HeapItem = std::tuple<uint64_t, size_t, size_t>;
+  std::priority_queue<HeapItem, std::vector<HeapItem>, std::greater<>> heap;
+  for (size_t stream = 0; stream < stream_list.size(); ++stream) {
+    if (stream_list[stream] != nullptr && !stream_list[stream]->Empty()) {
+      heap.emplace(stream_list[stream]->Timestamp(0), stream, 0);
+    }
+  }
+
+  while (!heap.empty()) {
+    const auto [timestamp, stream, index] = heap.top();
+    heap.pop();
+    const auto* source = stream_list[stream];
+    Add(source->At(index));
+    if (const size_t next = index + 1; next < source->Size()) {
+      heap.emplace(source->Timestamp(next), stream, next);
+    }
+  }
+}
+
+}  // namespace bus
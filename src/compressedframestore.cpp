@@ -0,0 +1,277 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#include "bus/compressedframestore.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <span>
+#include <unordered_map>
+
+namespace {
+
+constexpr size_t kNoFrame = std::numeric_limits<size_t>::max();
+
+// Generation 0 is an empty store and is never in a block cache.
+constexpr uint64_t kNoGeneration = 0;
+std::atomic<uint64_t> next_generation = kNoGeneration;
+
+/** \brief Decoded block in the per-thread block cache.
+ *
+ * The block is keyed on the store generation and not on the store
+ * address, as a new store may be allocated at the address of a deleted.
+ */
+struct DecodedBlock {
+  uint64_t generation = kNoGeneration;
+  size_t block = 0;
+  uint64_t last_used = 0;
+  bus::CanFrameStore frames;
+};
+
+bool IsErrorFrame(uint16_t flags) {
+  return (flags & bus::CanFrameFlag::FrameTypeMask) ==
+      static_cast<uint16_t>(bus::CanFrameType::ErrorFrame) << 10;
+}
+
+void PutVarint(std::vector<uint8_t>& dest, uint64_t value) {
+  while (value >= 0x80) {
+    dest.push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  dest.push_back(static_cast<uint8_t>(value));
+}
+
+uint64_t GetVarint(std::span<const uint8_t> source, size_t& pos) {
+  uint64_t value = 0;
+  for (int shift = 0; pos < source.size() && shift < 64; shift += 7) {
+    const uint8_t byte = source[pos++];
+    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      break;
+    }
+  }
+  return value;
+}
+
+}  // namespace
+
+namespace bus {
+
+size_t CompressedFrameStore::FrameKeyHash::operator()(
+    const FrameKey& key) const {
+  const uint64_t value = (static_cast<uint64_t>(key.message_id) << 32)
+      ^ (static_cast<uint64_t>(key.channel) << 24)
+      ^ (static_cast<uint64_t>(key.dlc) << 16) ^ key.flags;
+  return std::hash<uint64_t>{}(value);
+}
+
+void CompressedFrameStore::Clear() {
+  key_list_.clear();
+  block_list_.clear();
+  size_ = 0;
+  raw_size_ = 0;
+  generation_ = kNoGeneration;
+}
+
+void CompressedFrameStore::Compress(const CanFrameStore& store) {
+  Clear();
+  generation_ = ++next_generation;
+  size_ = store.Size();
+  raw_size_ = store.MemorySize();
+  block_list_.reserve((size_ + kBlockSize - 1) / kBlockSize);
+
+  std::unordered_map<FrameKey, uint32_t, FrameKeyHash> key_map;
+  std::vector<size_t> last_frame_list;  // Last frame of each key in a block.
+  for (size_t first = 0; first < size_; first += kBlockSize) {
+    const size_t last = std::min(first + kBlockSize, size_);
+    Block block;
+    block.first_time = store.Timestamp(first);
+    block.last_time = store.Timestamp(last - 1);
+    std::ranges::fill(last_frame_list, kNoFrame);
+
+    uint64_t previous_time = block.first_time;
+    for (size_t index = first; index < last; ++index) {
+      const CanFrameView frame = store.At(index);
+      const FrameKey key = {frame.MessageId(), frame.BusChannel(),
+                            frame.Dlc(), frame.Flags()};
+      const auto [itr, inserted] = key_map.try_emplace(
+          key, static_cast<uint32_t>(key_list_.size()));
+      if (inserted) {
+        key_list_.push_back(key);
+        last_frame_list.push_back(kNoFrame);
+      }
+      const uint32_t key_index = itr->second;
+
+      const auto data = frame.DataBytes();
+      bool same_data = false;
+      if (const size_t previous = last_frame_list[key_index];
+          previous != kNoFrame) {
+        same_data = std::ranges::equal(store.At(previous).DataBytes(), data);
+      }
+      last_frame_list[key_index] = index;
+
+      // The delta wraps around if the store isn't sorted, so the decoded
+      // time is still correct.
+      PutVarint(block.data, frame.Timestamp() - previous_time);
+      previous_time = frame.Timestamp();
+      PutVarint(block.data,
+                (static_cast<uint64_t>(key_index) << 1) | (same_data ? 1 : 0));
+      if (IsErrorFrame(key.flags)) {
+        PutVarint(block.data, frame.BitPosition());
+      }
+      if (!same_data) {
+        PutVarint(block.data, data.size());
+        block.data.insert(block.data.end(), data.begin(), data.end());
+      }
+    }
+    block.data.shrink_to_fit();
+    block_list_.emplace_back(std::move(block));
+  }
+  key_list_.shrink_to_fit();
+}
+
+void CompressedFrameStore::DecodeBlock(size_t block,
+                                       CanFrameStore& dest) const {
+  dest.Clear();
+  if (block >= block_list_.size()) {
+    return;
+  }
+  const Block& source = block_list_[block];
+  const std::span<const uint8_t> data(source.data);
+  const size_t nof_frames = std::min(kBlockSize, size_ - block * kBlockSize);
+  dest.Reserve(nof_frames, data.size());
+
+  std::vector<size_t> last_frame_list(key_list_.size(), kNoFrame);
+  std::vector<uint8_t> previous_data;
+  size_t pos = 0;
+  uint64_t time = source.first_time;
+  for (size_t index = 0; index < nof_frames; ++index) {
+    time += GetVarint(data, pos);
+    const uint64_t code = GetVarint(data, pos);
+    const auto key_index = static_cast<size_t>(code >> 1);
+    if (key_index >= key_list_.size()) {
+      break;  // Corrupt block.
+    }
+    const FrameKey& key = key_list_[key_index];
+    uint16_t bit_position = 0;
+    if (IsErrorFrame(key.flags)) {
+      bit_position = static_cast<uint16_t>(GetVarint(data, pos));
+    }
+
+    std::span<const uint8_t> frame_data;
+    if ((code & 1) != 0 && last_frame_list[key_index] != kNoFrame) {
+      // The data is copied as it is appended to the same store.
+      const auto previous = dest.At(last_frame_list[key_index]).DataBytes();
+      previous_data.assign(previous.begin(), previous.end());
+      frame_data = previous_data;
+    } else {
+      const auto length = static_cast<size_t>(GetVarint(data, pos));
+      frame_data = data.subspan(pos, std::min(length, data.size() - pos));
+      pos += frame_data.size();
+    }
+    last_frame_list[key_index] = index;
+    dest.Add(time, key.message_id, key.channel, key.dlc, key.flags,
+             frame_data, bit_position);
+  }
+}
+
+/**
+ * @brief Returns the decoded block from the thread block cache.
+ *
+ * The least recently used block in the cache is replaced.
+ */
+const CanFrameStore& CompressedFrameStore::DecodeBlock(size_t block) const {
+  thread_local std::array<DecodedBlock, kDecodeCacheSize> cache;
+  thread_local uint64_t use_counter = 0;
+  ++use_counter;
+  DecodedBlock* oldest = &cache[0];
+  for (auto& decoded : cache) {
+    if (generation_ != kNoGeneration && decoded.generation == generation_ &&
+        decoded.block == block) {
+      decoded.last_used = use_counter;
+      return decoded.frames;
+    }
+    if (decoded.last_used < oldest->last_used) {
+      oldest = &decoded;
+    }
+  }
+  DecodeBlock(block, oldest->frames);
+  oldest->generation = generation_;
+  oldest->block = block;
+  oldest->last_used = use_counter;
+  return oldest->frames;
+}
+
+CanFrameView CompressedFrameStore::At(size_t index) const {
+  if (index >= size_) {
+    return {};
+  }
+  return DecodeBlock(index / kBlockSize).At(index % kBlockSize);
+}
+
+uint64_t CompressedFrameStore::Timestamp(size_t index) const {
+  if (index >= size_) {
+    return 0;
+  }
+  if (index % kBlockSize == 0) {
+    return block_list_[index / kBlockSize].first_time;
+  }
+  return DecodeBlock(index / kBlockSize).Timestamp(index % kBlockSize);
+}
+
+uint64_t CompressedFrameStore::FirstTime() const {
+  return block_list_.empty() ? 0 : block_list_.front().first_time;
+}
+
+uint64_t CompressedFrameStore::LastTime() const {
+  return block_list_.empty() ? 0 : block_list_.back().last_time;
+}
+
+size_t CompressedFrameStore::LowerBound(uint64_t time) const {
+  // Only the block that holds the time is decoded.
+  const auto itr = std::ranges::partition_point(block_list_,
+      [time] (const Block& block) -> bool {
+        return block.last_time < time;
+      });
+  if (itr == block_list_.end()) {
+    return size_;
+  }
+  const auto block = static_cast<size_t>(itr - block_list_.begin());
+  return block * kBlockSize + DecodeBlock(block).LowerBound(time);
+}
+
+size_t CompressedFrameStore::UpperBound(uint64_t time) const {
+  const auto itr = std::ranges::partition_point(block_list_,
+      [time] (const Block& block) -> bool {
+        return block.last_time <= time;
+      });
+  if (itr == block_list_.end()) {
+    return size_;
+  }
+  const auto block = static_cast<size_t>(itr - block_list_.begin());
+  return block * kBlockSize + DecodeBlock(block).UpperBound(time);
+}
+
+std::pair<size_t, size_t> CompressedFrameStore::TimeRange(
+    uint64_t from, uint64_t to) const {
+  if (from > to) {
+    return {0, 0};
+  }
+  return {LowerBound(from), UpperBound(to)};
+}
+
+size_t CompressedFrameStore::MemorySize() const {
+  size_t size = key_list_.capacity() * sizeof(FrameKey)
+                + block_list_.capacity() * sizeof(Block);
+  for (const auto& block : block_list_) {
+    size += block.data.capacity();
+  }
+  return size;
+}
+
+}  // namespace bus
@@ -8,6 +8,9 @@
 #include <algorithm>
 #include <filesystem>
 #include <sstream>
+#include <thread>
+
+#include <bus/candataframe.h>
 
 #include "util/logstream.h"
 
@@ -17,6 +20,21 @@ using namespace dbc;
 using namespace metric;
 
 namespace {
+  /** \brief Counts a decode in progress while it is in scope. */
+  class DecodeScope {
+   public:
+    explicit DecodeScope(std::atomic<uint32_t>& counter)
+        : counter_(counter) {
+      ++counter_;
+    }
+    ~DecodeScope() { --counter_; }
+    DecodeScope(const DecodeScope&) = delete;
+    DecodeScope& operator=(const DecodeScope&) = delete;
+
+   private:
+    std::atomic<uint32_t>& counter_;
+  };
+
   void SetMetricDataType(const Signal& signal, Metric& metric) {
     const auto& enum_list = signal.EnumList();
     MetricProperty bits_prop("bits",std::to_string(signal.BitLength()) );
@@ -94,14 +112,18 @@ DbcDatabase::DbcDatabase() {
   type_ = TypeOfDatabase::DbcFile;
 }
 
+DbcDatabase::~DbcDatabase() {
+  CancelEnable();
+}
+
 void DbcDatabase::Enable( bool enable) {
-  IDatabase::Enable(enable);
   try {
-    operable_ = false;
+    // The database is operable when the decode plans are built.
+    StopDecoding();
     enabled_ = false;
     dbc_file_.reset();
-    group_list_.clear();
-    metric_list_.clear();
+    decoder_.Clear();
+    ClearGroups();
 
     if (!enable) {
       return;
@@ -125,7 +147,21 @@ void DbcDatabase::Enable( bool enable) {
       throw std::runtime_error("No network in the DBC file. File: "
                                + Filename());
     }
-    for (const auto& [msg_id, msg] : network->Messages()) {
+    // The file parsing is the first half of the progress.
+    const auto& message_list = network->Messages();
+    const uint64_t nof_steps = 2 * message_list.size();
+    uint64_t step = message_list.size();
+    enable_job_.Progress(step, nof_steps);
+    size_t nof_signals = 0;
+    for (const auto& [msg_id, msg] : message_list) {
+      nof_signals += msg.Signals().size();
+    }
+    ReserveGroups(message_list.size(), nof_signals);
+    for (const auto& [msg_id, msg] : message_list) {
+      if (enable_job_.IsCancelled()) {
+        throw std::runtime_error("The enable was cancelled.");
+      }
+      enable_job_.Progress(++step, nof_steps);
       auto* group = CreateGroup(msg.Name(), static_cast<uint32_t>(msg.Ident()));
       if (group == nullptr) {
         continue;
@@ -148,6 +184,8 @@ void DbcDatabase::Enable( bool enable) {
       }
       enabled_ = true;
     }
+    BuildDecoder();
+    operable_ = enabled_.load();
   } catch (const std::exception& err) {
     LOG_ERROR() << "Activation error. Filename: " << Filename()
       << ", Error: " << err.what();
@@ -156,5 +194,87 @@ void DbcDatabase::Enable( bool enable) {
   }
 }
 
+/**
+ * @brief Stops new decodes and waits for the decodes in progress.
+ *
+ * A decode counts itself before it checks the operable flag, so a decode
+ * that missed the flag is always waited for. The plans and metrics may be
+ * changed when this returns.
+ *
+ * @return True if the database was operable.
+ */
+bool DbcDatabase::StopDecoding() {
+  const bool operable = operable_.exchange(false);
+  while (nof_decoding_ > 0) {
+    std::this_thread::yield();
+  }
+  return operable;
+}
+
+void DbcDatabase::DeleteGroup(std::string name, uint32_t identity) {
+  const bool operable = StopDecoding();
+  IDatabase::DeleteGroup(std::move(name), identity);
+  BuildDecoder();
+  operable_ = operable;
+}
+
+void DbcDatabase::DeleteMetric(const DbGroup& group, std::string name) {
+  const bool operable = StopDecoding();
+  IDatabase::DeleteMetric(group, std::move(name));
+  BuildDecoder();
+  operable_ = operable;
+}
+
+/**
+ * @brief Builds the decode plans of the DBC signals.
+ *
+ * The plans point directly at the metrics, so they are rebuilt when a
+ * group or metric is deleted. Signals without a group or metric are not
+ * decoded.
+ */
+void DbcDatabase::BuildDecoder() {
+  decoder_.Clear();
+  const auto* network = dbc_file_ ? dbc_file_->GetNetwork() : nullptr;
+  if (network == nullptr) {
+    return;
+  }
+  for (const auto& [msg_id, msg] : network->Messages()) {
+    const auto* group = GetGroup(msg.Name(),
+                                 static_cast<uint32_t>(msg.Ident()));
+    if (group == nullptr) {
+      continue;
+    }
+    for (const auto& [signal_name, signal] : msg.Signals()) {
+      auto* metric = GetMetric(*group, signal_name);
+      if (metric != nullptr) {
+        decoder_.AddSignal(static_cast<uint32_t>(msg.Ident()), signal,
+                           *metric);
+      }
+    }
+  }
+}
+
+void DbcDatabase::ParseMessage(const IBusMessage& message) {
+  if (message.Type() != BusMessageType::Can_DataFrame) {
+    return;
+  }
+  const DecodeScope scope(nof_decoding_);
+  if (!operable_) {
+    return;
+  }
+  const auto& frame = static_cast<const CanDataFrame&>(message);
+  decoder_.Decode(frame.MessageId(), frame.Timestamp(), frame.DataBytes());
+}
+
+bool DbcDatabase::ParseBatch(uint32_t message_id,
+                             std::span<const CanFrameView> frames,
+                             std::vector<SignalColumn>& columns) const {
+  const DecodeScope scope(nof_decoding_);
+  if (!operable_) {
+    columns.clear();
+    return false;
+  }
+  return decoder_.DecodeBatch(message_id, frames, columns);
+}
 
 }  // namespace bus
\ No newline at end of file
@@ -5,4 +5,53 @@
 
 #include "bus/dbmetric.h"
 
-namespace bus {}  // namespace bus
\ No newline at end of file
+#include <thread>
+
+namespace bus {
+
+void DbMetric::Value(double value, uint64_t timestamp) {
+  Store({value, timestamp, true});
+}
+
+void DbMetric::ResetValue() {
+  Store({});
+}
+
+/**
+ * @brief Writes the value between two sequence increments.
+ *
+ * The fields are relaxed atomics, so a reader that races with the writer
+ * reads stale fields but never torn ones. The sequence tells the reader
+ * to retry.
+ */
+void DbMetric::Store(const MetricValue& value) {
+  const uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+  sequence_.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  value_.store(value.value, std::memory_order_relaxed);
+  timestamp_.store(value.timestamp, std::memory_order_relaxed);
+  valid_.store(value.valid, std::memory_order_relaxed);
+  sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+MetricValue DbMetric::Snapshot() const {
+  MetricValue snapshot;
+  for (size_t retry = 0; ; ++retry) {
+    const uint32_t sequence = sequence_.load(std::memory_order_acquire);
+    if ((sequence & 1) == 0) {
+      snapshot.value = value_.load(std::memory_order_relaxed);
+      snapshot.timestamp = timestamp_.load(std::memory_order_relaxed);
+      snapshot.valid = valid_.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence_.load(std::memory_order_relaxed) == sequence) {
+        break;
+      }
+    }
+    if (retry >= 64) {
+      std::this_thread::yield();
+    }
+  }
+  return snapshot;
+}
+
+}  // namespace bus
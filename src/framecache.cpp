@@ -0,0 +1,361 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#include "bus/framecache.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <util/logstream.h>
+
+using namespace std::filesystem;
+using namespace util::log;
+
+namespace {
+
+constexpr std::array<char, 8> kMagic = {'B', 'U', 'S', 'F', 'R', 'M', 'C', '1'};
+constexpr uint32_t kVersion = 4;
+constexpr size_t kHeaderHashSize = 65'536;
+constexpr std::string_view kCacheExtension = ".framecache";
+
+constexpr uint64_t kFnvOffset = 14'695'981'039'346'656'037ULL;
+constexpr uint64_t kFnvPrime = 1'099'511'628'211ULL;
+
+struct CacheHeader {
+  std::array<char, 8> magic = kMagic;
+  uint32_t version = kVersion;
+  uint32_t header_size = 0;
+  uint64_t path_hash = 0;
+  uint64_t file_size = 0;
+  int64_t modified = 0;
+  uint64_t header_hash = 0;
+  uint64_t content_key = 0;
+  uint64_t start_time = 0;
+  uint64_t nof_frames = 0;
+  uint64_t nof_bytes = 0;
+  uint64_t nof_index = 0;
+};
+static_assert(sizeof(CacheHeader) % 8 == 0);
+
+uint64_t Fnv1a(std::span<const uint8_t> data) {
+  uint64_t hash = kFnvOffset;
+  for (const uint8_t byte : data) {
+    hash ^= byte;
+    hash *= kFnvPrime;
+  }
+  return hash;
+}
+
+constexpr size_t Align(size_t size) {
+  return (size + 7) & ~size_t{7};
+}
+
+/** \brief Returns a header with the MDF file fingerprint. */
+CacheHeader MakeFingerprint(const std::string& mdf_file,
+                            uint64_t content_key) {
+  const path fullname = absolute(path(mdf_file)).lexically_normal();
+  const std::string name = fullname.generic_string();
+
+  CacheHeader header;
+  header.header_size = sizeof(CacheHeader);
+  header.path_hash = Fnv1a({reinterpret_cast<const uint8_t*>(name.data()),
+                            name.size()});
+  header.file_size = file_size(fullname);
+  header.modified = last_write_time(fullname).time_since_epoch().count();
+  header.content_key = content_key;
+
+  std::ifstream file(fullname, std::ios::binary);
+  if (!file.is_open()) {
+    throw std::runtime_error("Didn't open the MDF file.");
+  }
+  std::vector<uint8_t> buffer(std::min<uint64_t>(header.file_size,
+                                                 kHeaderHashSize));
+  file.read(reinterpret_cast<char*>(buffer.data()),
+            static_cast<std::streamsize>(buffer.size()));
+  if (!file) {
+    throw std::runtime_error("Didn't read the MDF file header.");
+  }
+  header.header_hash = Fnv1a(buffer);
+  return header;
+}
+
+/** \brief Returns the value as 16 hexadecimal digits. */
+std::string ToHex(uint64_t value) {
+  std::ostringstream hex;
+  hex << std::hex << std::setw(16) << std::setfill('0') << value;
+  return hex.str();
+}
+
+bool IsSameFile(const CacheHeader& cache, const CacheHeader& fingerprint) {
+  return cache.magic == kMagic && cache.version == kVersion &&
+         cache.header_size == sizeof(CacheHeader) &&
+         cache.path_hash == fingerprint.path_hash &&
+         cache.file_size == fingerprint.file_size &&
+         cache.modified == fingerprint.modified &&
+         cache.header_hash == fingerprint.header_hash &&
+         cache.content_key == fingerprint.content_key;
+}
+
+/** \brief Read-only memory mapping of a file. */
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& filename);
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  [[nodiscard]] const uint8_t* Data() const { return data_; }
+  [[nodiscard]] size_t Size() const { return size_; }
+
+ private:
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+#ifdef _WIN32
+  HANDLE file_ = INVALID_HANDLE_VALUE;
+  HANDLE mapping_ = nullptr;
+#endif
+};
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string& filename) {
+  const path fullname(filename);
+  file_ = CreateFileW(fullname.wstring().c_str(), GENERIC_READ,
+                      FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file_ == INVALID_HANDLE_VALUE) {
+    throw std::runtime_error("Didn't open the cache file.");
+  }
+  LARGE_INTEGER size;
+  if (GetFileSizeEx(file_, &size) == 0 || size.QuadPart <= 0) {
+    CloseHandle(file_);
+    throw std::runtime_error("Invalid cache file size.");
+  }
+  size_ = static_cast<size_t>(size.QuadPart);
+  mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0,
+                                nullptr);
+  if (mapping_ == nullptr) {
+    CloseHandle(file_);
+    throw std::runtime_error("Didn't map the cache file.");
+  }
+  data_ = static_cast<const uint8_t*>(
+      MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+  if (data_ == nullptr) {
+    CloseHandle(mapping_);
+    CloseHandle(file_);
+    throw std::runtime_error("Didn't map the cache file.");
+  }
+}
+
+MappedFile::~MappedFile() {
+  UnmapViewOfFile(data_);
+  CloseHandle(mapping_);
+  CloseHandle(file_);
+}
+#else
+MappedFile::MappedFile(const std::string& filename) {
+  const int file = open(filename.c_str(), O_RDONLY);
+  if (file < 0) {
+    throw std::runtime_error("Didn't open the cache file.");
+  }
+  struct stat info {};
+  if (fstat(file, &info) != 0 || info.st_size <= 0) {
+    close(file);
+    throw std::runtime_error("Invalid cache file size.");
+  }
+  size_ = static_cast<size_t>(info.st_size);
+  void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file, 0);
+  close(file);
+  if (data == MAP_FAILED) {
+    throw std::runtime_error("Didn't map the cache file.");
+  }
+  data_ = static_cast<const uint8_t*>(data);
+}
+
+MappedFile::~MappedFile() {
+  munmap(const_cast<uint8_t*>(data_), size_);
+}
+#endif
+
+}  // namespace
+
+namespace bus {
+
+FrameCache::FrameCache(std::string mdf_file, uint64_t content_key)
+    : mdf_file_(std::move(mdf_file)),
+      cache_file_(mdf_file_ + "." + ToHex(content_key) +
+                  std::string(kCacheExtension)),
+      content_key_(content_key) {}
+
+bool FrameCache::IsValid() const {
+  try {
+    if (!exists(cache_file_)) {
+      return false;
+    }
+    std::ifstream file(cache_file_, std::ios::binary);
+    CacheHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(CacheHeader));
+    return file && IsSameFile(header,
+                              MakeFingerprint(mdf_file_, content_key_));
+  } catch (const std::exception& err) {
+    LOG_TRACE() << "Didn't check the frame cache. Error: " << err.what()
+      << ", File: " << cache_file_;
+  }
+  return false;
+}
+
+/**
+ * @brief Maps the cache file into the frame store.
+ *
+ * The columns are stored after the header in the same order as in the
+ * frame store, each column aligned to 8 bytes. The store columns become
+ * views of the mapped file, so nothing is copied.
+ */
+bool FrameCache::Load(CanFrameStore& store, uint64_t& start_time) const {
+  try {
+    if (!exists(cache_file_)) {
+      return false;
+    }
+    const CacheHeader fingerprint = MakeFingerprint(mdf_file_, content_key_);
+    auto file = std::make_shared<MappedFile>(cache_file_);
+    CacheHeader header;
+    if (file->Size() < sizeof(CacheHeader)) {
+      throw std::runtime_error("Invalid cache file size.");
+    }
+    std::memcpy(&header, file->Data(), sizeof(CacheHeader));
+    if (!IsSameFile(header, fingerprint)) {
+      LOG_TRACE() << "The frame cache is outdated. File: " << cache_file_;
+      return false;
+    }
+
+    auto columns = std::make_shared<CanFrameStore::MappedColumns>();
+    size_t offset = sizeof(CacheHeader);
+    const auto map_column = [&] <typename T> (std::span<const T>& column,
+                                               uint64_t count) {
+      if (count > (file->Size() - offset) / sizeof(T)) {
+        throw std::runtime_error("The cache file is truncated.");
+      }
+      const size_t nof_bytes = count * sizeof(T);
+      column = {reinterpret_cast<const T*>(file->Data() + offset), count};
+      offset += Align(nof_bytes);
+    };
+    map_column(columns->timestamps, header.nof_frames);
+    map_column(columns->message_ids, header.nof_frames);
+    map_column(columns->channels, header.nof_frames);
+    map_column(columns->dlcs, header.nof_frames);
+    map_column(columns->flags, header.nof_frames);
+    map_column(columns->offsets, header.nof_frames + 1);
+    map_column(columns->payload, header.nof_bytes);
+    map_column(columns->time_index, header.nof_index);
+    if (offset != file->Size()) {
+      throw std::runtime_error("The cache file size doesn't match the header.");
+    }
+
+    // The store reads the columns without range checks, so the columns
+    // shall be consistent before they are attached.
+    constexpr uint64_t kStep = CanFrameStore::kTimeIndexStep;
+    if (header.nof_index != (header.nof_frames + kStep - 1) / kStep) {
+      throw std::runtime_error("The time index doesn't match the frames.");
+    }
+    const auto& offsets = columns->offsets;
+    if (offsets.front() != 0 || offsets.back() > header.nof_bytes) {
+      throw std::runtime_error("The frame data is outside the payload.");
+    }
+    if (!std::ranges::is_sorted(offsets)) {
+      throw std::runtime_error("The frame data offsets aren't in order.");
+    }
+    columns->owner = file;
+
+    store.Attach(std::move(columns));
+    start_time = header.start_time;
+  } catch (const std::exception& err) {
+    LOG_ERROR() << "Didn't load the frame cache. Error: " << err.what()
+      << ", File: " << cache_file_;
+    return false;
+  }
+  return true;
+}
+
+bool FrameCache::Save(const CanFrameStore& store, uint64_t start_time) const {
+  if (store.IsMapped()) {
+    return true;
+  }
+  // Sources may save the same cache at the same time, so each save has its
+  // own temporary file.
+  std::random_device random;
+  const std::string temp_file = cache_file_ + "." +
+      ToHex((static_cast<uint64_t>(random()) << 32) | random()) + ".tmp";
+  try {
+    CacheHeader header = MakeFingerprint(mdf_file_, content_key_);
+    header.start_time = start_time;
+    header.nof_frames = store.Size();
+    header.nof_bytes = store.PayloadColumn().size();
+    header.nof_index = store.TimeIndexColumn().size();
+    {
+      std::ofstream file(temp_file, std::ios::binary | std::ios::trunc);
+      if (!file.is_open()) {
+        throw std::runtime_error("Didn't create the cache file.");
+      }
+      file.write(reinterpret_cast<const char*>(&header), sizeof(CacheHeader));
+      const auto write_column = [&] <typename T> (std::span<const T> column) {
+        file.write(reinterpret_cast<const char*>(column.data()),
+                   static_cast<std::streamsize>(column.size_bytes()));
+        const size_t padding = Align(column.size_bytes())
+            - column.size_bytes();
+        constexpr std::array<char, 8> kZeros = {};
+        file.write(kZeros.data(), static_cast<std::streamsize>(padding));
+      };
+      write_column(store.TimestampColumn());
+      write_column(store.MessageIdColumn());
+      write_column(store.ChannelColumn());
+      write_column(store.DlcColumn());
+      write_column(store.FlagColumn());
+      write_column(store.OffsetColumn());
+      write_column(store.PayloadColumn());
+      write_column(store.TimeIndexColumn());
+      if (!file) {
+        throw std::runtime_error("Didn't write the cache file.");
+      }
+    }
+    // The cache is replaced in one step, so a reader never sees a partly
+    // written cache file.
+    rename(temp_file, cache_file_);
+  } catch (const std::exception& err) {
+    LOG_TRACE() << "Didn't save the frame cache. Error: " << err.what()
+      << ", File: " << cache_file_;
+    std::error_code dummy;
+    remove(temp_file, dummy);
+    return false;
+  }
+  return true;
+}
+
+void FrameCache::Remove() const {
+  std::error_code dummy;
+  remove(cache_file_, dummy);
+}
+
+}  // namespace bus
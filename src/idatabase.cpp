@@ -3,6 +3,7 @@
 * SPDX-License-Identifier: MIT
 */
 #include <cstdint>
+#include <functional>
 #include <string>
 #include <ranges>
 #include <array>
@@ -39,6 +40,26 @@ void IDatabase::Enable(bool enable) {
   operable_ = enable;
 }
 
+void IDatabase::EnableAsync(bool enable, BackgroundJob::DoneFunction done) {
+  if (!enable) {
+    CancelEnable();
+    Enable(false);
+    if (done) {
+      done(true);
+    }
+    return;
+  }
+  enable_job_.Start([this] () -> bool {
+    Enable(true);
+    return IsEnabled();
+  }, std::move(done));
+}
+
+void IDatabase::CancelEnable() {
+  enable_job_.Cancel();
+  enable_job_.Wait();
+}
+
 void IDatabase::WriteConfig(IXmlNode& root_node) const {
   auto& db_node = root_node.AddNode("Database");
   db_node.SetAttribute("name", name_);
@@ -47,7 +68,7 @@ void IDatabase::WriteConfig(IXmlNode& root_node) const {
   db_node.SetProperty("Name", name_);
   db_node.SetProperty("Description", description_);
   db_node.SetProperty("Filename", filename_);
-  db_node.SetProperty("Enabled", IsEnabled());
+  db_node.SetProperty("Enabled", IsEnabled() || IsEnabling());
 }
 
 void IDatabase::ReadConfig(const IXmlNode& db_node) {
@@ -98,57 +119,153 @@ void IDatabase::ToProperties(std::vector<BusProperty>& properties) const {
   properties.emplace_back("Status");
   properties.emplace_back("Enabled", enabled_ ? (enabled_ ? "Enabled" : "Failing") : "Disabled");
   properties.emplace_back("Operable", operable_ ? "Yes" : "No");
+  if (IsEnabling()) {
+    const auto progress = static_cast<int>(EnableProgress() * 100.0);
+    properties.emplace_back("Loading", std::to_string(progress), "%");
+  }
 }
 
 void IDatabase::ParseMessage(const IBusMessage& message) {}
 
+bool IDatabase::ParseBatch(uint32_t /* message_id */,
+                           std::span<const CanFrameView> /* frames */,
+                           std::vector<SignalColumn>& columns) const {
+  columns.clear();
+  return false;
+}
+
+size_t IDatabase::KeyHash::operator()(const GroupKey& key) const {
+  return std::hash<std::string>{}(key.name) ^
+         (std::hash<uint32_t>{}(key.identity) << 1);
+}
+
+size_t IDatabase::KeyHash::operator()(const MetricKey& key) const {
+  size_t hash = std::hash<std::string>{}(key.group_name);
+  hash ^= std::hash<uint32_t>{}(key.group_id) + 0x9E3779B9 + (hash << 6)
+          + (hash >> 2);
+  hash ^= std::hash<std::string>{}(key.name) + 0x9E3779B9 + (hash << 6)
+          + (hash >> 2);
+  return hash;
+}
+
 DbGroup* IDatabase::CreateGroup(std::string name, uint32_t identity) {
-  auto itr = std::ranges::find_if( group_list_, [&] (const auto& group) -> bool {
-    return group && group->Name() == name && group->Identity() == identity;
-  });
-  if (itr == group_list_.end()) {
-    if (auto new_group = std::make_unique<DbGroup>(); new_group ) {
-      new_group->Name(std::move(name));
-      new_group->Identity(identity);
-      group_list_.emplace_back(std::move(new_group));
-    } else {
-      return itr->get();
-    }
+  if (auto* group = GetGroup(name, identity); group != nullptr) {
+    return group;
   }
-  return group_list_.back().get();
+  auto new_group = std::make_unique<DbGroup>();
+  new_group->Name(name);
+  new_group->Identity(identity);
+  auto* group = new_group.get();
+  group_index_.emplace(GroupKey{std::move(name), identity},
+                       group_list_.size());
+  identity_index_.emplace(identity, group);
+  group_list_.emplace_back(std::move(new_group));
+  return group;
 }
 
+/**
+ * @brief Deletes a group.
+ *
+ * The last group is moved into the position of the deleted group, so the
+ * order of the group list isn't kept.
+ */
 void IDatabase::DeleteGroup(std::string name, uint32_t identity) {
-  std::erase_if(group_list_, [&] (const auto& group) -> bool {
-    return !group || (group->Name() == name && group->Identity() == identity);
-  });
+  const auto itr = group_index_.find(GroupKey{std::move(name), identity});
+  if (itr == group_index_.end()) {
+    return;
+  }
+  const size_t index = itr->second;
+  group_index_.erase(itr);
+
+  auto [first, last] = identity_index_.equal_range(identity);
+  for (auto id_itr = first; id_itr != last; ++id_itr) {
+    if (id_itr->second == group_list_[index].get()) {
+      identity_index_.erase(id_itr);
+      break;
+    }
+  }
+
+  if (index + 1 < group_list_.size()) {
+    auto& moved = group_list_.back();
+    group_index_[GroupKey{moved->Name(), moved->Identity()}] = index;
+    group_list_[index] = std::move(moved);
+  }
+  group_list_.pop_back();
+}
+
+DbGroup* IDatabase::GetGroup(const std::string& name,
+                             uint32_t identity) const {
+  const auto itr = group_index_.find(GroupKey{name, identity});
+  return itr != group_index_.cend() ? group_list_[itr->second].get()
+                                    : nullptr;
+}
+
+DbGroup* IDatabase::GetGroup(uint32_t identity) const {
+  const auto itr = identity_index_.find(identity);
+  return itr != identity_index_.cend() ? itr->second : nullptr;
 }
 
 DbMetric* IDatabase::CreateMetric(const DbGroup& group, std::string name) {
-  auto itr = std::ranges::find_if( metric_list_, [&] (const auto& metric) -> bool {
-    return metric && group.Name() == metric->GroupName()
-           && group.Identity() == metric->GroupId() && metric->Name() == name;
-  });
-  if (itr == metric_list_.end()) {
-    if (auto new_metric = std::make_unique<DbMetric>(); new_metric ) {
-      new_metric->Name(std::move(name));
-      new_metric->GroupName(group.Name());
-      new_metric->GroupId(group.Identity());
-      metric_list_.emplace_back(std::move(new_metric));
-    } else {
-      return itr->get();
-    }
+  if (auto* metric = GetMetric(group, name); metric != nullptr) {
+    return metric;
   }
-  return metric_list_.back().get();
+  auto new_metric = std::make_unique<DbMetric>();
+  new_metric->Name(name);
+  new_metric->GroupName(group.Name());
+  new_metric->GroupId(group.Identity());
+  auto* metric = new_metric.get();
+  metric_index_.emplace(
+      MetricKey{group.Name(), group.Identity(), std::move(name)},
+      metric_list_.size());
+  metric_list_.emplace_back(std::move(new_metric));
+  return metric;
 }
 
+/**
+ * @brief Deletes a metric.
+ *
+ * The last metric is moved into the position of the deleted metric, so
+ * the order of the metric list isn't kept.
+ */
 void IDatabase::DeleteMetric(const DbGroup& group, std::string name) {
-  std::erase_if(metric_list_, [&] (const auto& metric) -> bool {
-    return !metric ||
-           (metric->GroupName() == group.Name()
-            && metric->GroupId() == group.Identity()
-            && metric->Name() == name);
-  });
+  const auto itr = metric_index_.find(
+      MetricKey{group.Name(), group.Identity(), std::move(name)});
+  if (itr == metric_index_.end()) {
+    return;
+  }
+  const size_t index = itr->second;
+  metric_index_.erase(itr);
+  if (index + 1 < metric_list_.size()) {
+    auto& moved = metric_list_.back();
+    metric_index_[MetricKey{moved->GroupName(), moved->GroupId(),
+                            moved->Name()}] = index;
+    metric_list_[index] = std::move(moved);
+  }
+  metric_list_.pop_back();
+}
+
+DbMetric* IDatabase::GetMetric(const DbGroup& group,
+                               const std::string& name) const {
+  const auto itr = metric_index_.find(
+      MetricKey{group.Name(), group.Identity(), name});
+  return itr != metric_index_.cend() ? metric_list_[itr->second].get()
+                                     : nullptr;
+}
+
+void IDatabase::ClearGroups() {
+  metric_index_.clear();
+  group_index_.clear();
+  identity_index_.clear();
+  metric_list_.clear();
+  group_list_.clear();
+}
+
+void IDatabase::ReserveGroups(size_t nof_groups, size_t nof_metrics) {
+  group_list_.reserve(nof_groups);
+  group_index_.reserve(nof_groups);
+  identity_index_.reserve(nof_groups);
+  metric_list_.reserve(nof_metrics);
+  metric_index_.reserve(nof_metrics);
 }
 
 }  // namespace bus
\ No newline at end of file
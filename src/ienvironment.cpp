@@ -45,6 +45,10 @@ void IEnvironment::Stop() {
   operable_ = false;
 }
 
+std::shared_ptr<IBusMessageQueue> IEnvironment::CreatePublisher() {
+  return {};
+}
+
 void IEnvironment::WriteConfig(IXmlNode& root_node) const {
    auto& env_node = root_node.AddNode("Environment");
    env_node.SetAttribute("name", name_);
@@ -6,6 +6,7 @@
 #include <array>
 
 #include <util/ixmlnode.h>
+#include <util/logstream.h>
 #include <util/stringutil.h>
 
 #include "bus/isource.h"
@@ -15,8 +16,8 @@ using namespace util::string;
 
 namespace {
 
-constexpr std::array<std::string_view, 2> kTypeList =
-   { "Unknown", "MDF Traffic Generator" };
+constexpr std::array<std::string_view, 3> kTypeList =
+   { "Unknown", "MDF Traffic Generator", "MDF Playlist" };
 }
 
 namespace bus {
@@ -27,11 +28,19 @@ ISource& ISource::operator=(const ISource& source) {
  }
  name_ = source.name_;
  description_ = source.description_;
+ filename_ = source.filename_;
+ environment_name_ = source.environment_name_;
  // Not copying the type and all the dynamic properties.
  return *this;
 }
 void ISource::Start() {
-  if (enabled_) {
+  if (IsEnabling()) {
+    // The enable job is still building the source.
+    LOG_ERROR() << "The source is loading and cannot be started. Source: "
+                << name_;
+    started_ = false;
+    operable_ = false;
+  } else if (enabled_) {
     started_ = true;
     operable_ = true;
   } else {
@@ -45,15 +54,50 @@ void ISource::Stop() {
  operable_ = false;
 }
 
+void ISource::EnableAsync(bool enable, BackgroundJob::DoneFunction done) {
+ if (IsSynchronized()) {
+   // The coordinator thread reads the source data.
+   LOG_ERROR() << "The synchronized replay shall be stopped first. Source: "
+               << name_;
+   if (done) {
+     done(false);
+   }
+   return;
+ }
+ if (!enable) {
+   CancelEnable();
+   Enable(false);
+   if (done) {
+     done(true);
+   }
+   return;
+ }
+ enable_job_.Start([this] () -> bool {
+   Enable(true);
+   return IsEnabled();
+ }, std::move(done));
+}
+
+void ISource::CancelEnable() {
+ enable_job_.Cancel();
+ enable_job_.Wait();
+}
+
 void ISource::WriteConfig(IXmlNode& root_node) const {
  auto& source_node = root_node.AddNode("Source");
  source_node.SetAttribute("name", name_);
  source_node.SetAttribute("type", TypeToString(type_));
+ WriteProperties(source_node);
+}
+
+void ISource::WriteProperties(IXmlNode& source_node) const {
  source_node.SetProperty("Type", TypeToString(type_));
  source_node.SetProperty("Name", name_);
  source_node.SetProperty("Description", description_);
  source_node.SetProperty("Filename", filename_);
- source_node.SetProperty("Enabled", enabled_);
+ source_node.SetProperty("Environment", environment_name_);
+ // A source that is enabling, is disabled until the enable is done.
+ source_node.SetProperty("Enabled", enabled_ || IsEnabling());
 }
 
 void ISource::ReadConfig(const IXmlNode& source_node) {
@@ -65,6 +109,7 @@ void ISource::ReadConfig(const IXmlNode& source_node) {
  // right environment type.
  description_ = source_node.Property<std::string>("Description");
  filename_ = source_node.Property<std::string>("Filename");
+ environment_name_ = source_node.Property<std::string>("Environment");
  enabled_ = source_node.Property<bool>("Enabled");
 }
 
@@ -96,11 +141,18 @@ void ISource::ToProperties(std::vector<BusProperty>& properties) const {
  properties.emplace_back("Type", std::string(TypeToString(type_)));
  properties.emplace_back("Name", Name());
  properties.emplace_back("Filename", Filename());
+ properties.emplace_back("Environment", EnvironmentName());
  properties.emplace_back();
  properties.emplace_back("Status");
  properties.emplace_back("Enabled", enabled_ ? "Yes" : "No");
- properties.emplace_back("State", started_ ?
-                         (operable_ ? "Running" : "Failing") : "Stopped");
+ if (IsEnabling()) {
+   const auto progress = static_cast<int>(EnableProgress() * 100.0);
+   properties.emplace_back("State", "Loading");
+   properties.emplace_back("Progress", std::to_string(progress), "%");
+ } else {
+   properties.emplace_back("State", started_ ?
+                           (operable_ ? "Running" : "Failing") : "Stopped");
+ }
  properties.emplace_back("Operable", operable_ ? "Yes" : "No");
 }
 
@@ -0,0 +1,389 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#include "bus/mdfplaylist.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <string_view>
+#include <tuple>
+
+#include <util/logstream.h>
+#include <util/ixmlnode.h>
+
+#include <mdf/mdfreader.h>
+
+#include "bus/mdftrafficgenerator.h"
+
+using namespace std::filesystem;
+using namespace util::log;
+using namespace util::xml;
+using namespace mdf;
+
+namespace {
+
+/** \brief Interval that a file load checks the cancel of its caller. */
+constexpr std::chrono::milliseconds kCancelInterval(50);
+
+/** \brief Matches a file name against a pattern with * and ? wildcards. */
+bool MatchWildcard(std::string_view name, std::string_view pattern) {
+  size_t name_pos = 0;
+  size_t pattern_pos = 0;
+  size_t star_pos = std::string_view::npos;
+  size_t star_match = 0;
+  while (name_pos < name.size()) {
+    if (pattern_pos < pattern.size() &&
+        (pattern[pattern_pos] == '?' ||
+         pattern[pattern_pos] == name[name_pos])) {
+      ++name_pos;
+      ++pattern_pos;
+    } else if (pattern_pos < pattern.size() && pattern[pattern_pos] == '*') {
+      star_pos = pattern_pos++;
+      star_match = name_pos;
+    } else if (star_pos != std::string_view::npos) {
+      // Let the last star match one more character.
+      pattern_pos = star_pos + 1;
+      name_pos = ++star_match;
+    } else {
+      return false;
+    }
+  }
+  while (pattern_pos < pattern.size() && pattern[pattern_pos] == '*') {
+    ++pattern_pos;
+  }
+  return pattern_pos == pattern.size();
+}
+
+}  // namespace
+
+namespace bus {
+
+MdfPlaylist::MdfPlaylist() {
+  type_ = TypeOfSource::MdfPlaylist;
+}
+
+MdfPlaylist::~MdfPlaylist() {
+  CancelEnable();
+  MdfPlaylist::Stop();
+  prefetch_job_.Cancel();
+  prefetch_job_.Wait();
+}
+
+void MdfPlaylist::Enable(bool enable) {
+  Stop();
+  enabled_ = false;
+  operable_ = false;
+  prefetch_job_.Cancel();
+  prefetch_job_.Wait();
+  current_.reset();
+  next_.reset();
+  current_index_ = 0;
+  if (!enable) {
+    return;
+  }
+
+  if (!ScanFiles()) {
+    LOG_ERROR() << "Didn't find any MDF files. Source: " << Name()
+      << ", Path: " << Filename();
+    return;
+  }
+  if (!LoadFirstFile()) {
+    LOG_ERROR() << "Didn't read any MDF file in the playlist. Source: "
+      << Name();
+    return;
+  }
+  enabled_ = true;
+  operable_ = true;
+}
+
+/**
+ * @brief Finds the MDF files and orders them by measurement start time.
+ *
+ * Only the header of each file is read. Files with equal start time are
+ * ordered by name.
+ */
+bool MdfPlaylist::ScanFiles() {
+  file_list_.clear();
+  try {
+    const path fullname(Filename());
+    if (fullname.empty()) {
+      throw std::runtime_error("Empty path.");
+    }
+    path directory = fullname;
+    std::string pattern = "*";
+    if (!is_directory(fullname)) {
+      directory = fullname.parent_path();
+      pattern = fullname.filename().string();
+    }
+    if (!is_directory(directory)) {
+      throw std::runtime_error("The directory doesn't exist.");
+    }
+
+    std::vector<std::string> candidate_list;
+    for (const auto& entry : directory_iterator(directory)) {
+      if (entry.is_regular_file() &&
+          MatchWildcard(entry.path().filename().string(), pattern)) {
+        candidate_list.emplace_back(entry.path().string());
+      }
+    }
+
+    for (size_t index = 0; index < candidate_list.size(); ++index) {
+      if (enable_job_.IsCancelled()) {
+        return false;
+      }
+      enable_job_.Progress(index, candidate_list.size());
+      const auto& filename = candidate_list[index];
+      if (!IsMdfFile(filename)) {
+        continue;
+      }
+      MdfReader reader(filename);
+      const auto* mdf_file = reader.ReadHeader() ? reader.GetFile() : nullptr;
+      const auto* header = mdf_file != nullptr ? mdf_file->Header() : nullptr;
+      if (header == nullptr) {
+        LOG_ERROR() << "Didn't read the MDF header. File: " << filename;
+        continue;
+      }
+      PlaylistFile file;
+      file.filename = filename;
+      file.start_time = header->StartTime();
+      file_list_.emplace_back(std::move(file));
+    }
+  } catch (const std::exception& err) {
+    LOG_ERROR() << "Didn't scan the playlist. Path: " << Filename()
+                << ", Error: " << err.what();
+    file_list_.clear();
+    return false;
+  }
+
+  std::ranges::sort(file_list_, [] (const PlaylistFile& file1,
+                                    const PlaylistFile& file2) -> bool {
+    return std::tie(file1.start_time, file1.filename) <
+           std::tie(file2.start_time, file2.filename);
+  });
+  LOG_TRACE() << "Found " << file_list_.size()
+    << " MDF files. Source: " << Name();
+  return !file_list_.empty();
+}
+
+/**
+ * @brief Loads a file in the enable job of a new generator.
+ *
+ * The load is cancelled when the calling job is cancelled, so a cancel
+ * doesn't wait until the whole file has been read.
+ */
+std::unique_ptr<MdfTrafficGenerator> MdfPlaylist::LoadFile(
+    size_t index, const BackgroundJob& job) const {
+  if (index >= file_list_.size()) {
+    return {};
+  }
+  auto generator = std::make_unique<MdfTrafficGenerator>();
+  generator->Name(Name());
+  generator->Filename(file_list_[index].filename);
+  generator->EnvironmentName(EnvironmentName());
+  generator->UseCache(use_cache_);
+  generator->Filter() = filter_;
+
+  std::promise<bool> enabled;
+  auto result = enabled.get_future();
+  generator->EnableAsync(true, [&enabled] (bool enable) {
+    enabled.set_value(enable);
+  });
+  while (result.wait_for(kCancelInterval) != std::future_status::ready) {
+    if (job.IsCancelled()) {
+      generator->CancelEnable();
+      return {};
+    }
+  }
+  if (!result.get()) {
+    LOG_ERROR() << "Skipped a playlist file. Source: " << Name()
+      << ", File: " << file_list_[index].filename;
+    return {};
+  }
+  return generator;
+}
+
+bool MdfPlaylist::LoadFirstFile() {
+  prefetch_job_.Cancel();
+  prefetch_job_.Wait();
+  next_.reset();
+  current_.reset();
+  for (size_t index = 0; index < file_list_.size(); ++index) {
+    if (enable_job_.IsCancelled()) {
+      return false;
+    }
+    current_ = LoadFile(index, enable_job_);
+    if (current_) {
+      current_index_ = index;
+      first_index_ = index;
+      Prefetch(index + 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Loads the next file in the background.
+ *
+ * Files that can't be read are skipped. The previous next file is released
+ * first, so at most two files are held in memory.
+ */
+void MdfPlaylist::Prefetch(size_t index) {
+  prefetch_job_.Start([this, index] () -> bool {
+    next_.reset();
+    for (size_t file = index; file < file_list_.size(); ++file) {
+      if (prefetch_job_.IsCancelled()) {
+        break;
+      }
+      prefetch_job_.Progress(file - index, file_list_.size() - index);
+      if (auto generator = LoadFile(file, prefetch_job_); generator) {
+        next_ = std::move(generator);
+        next_index_ = file;
+        return true;
+      }
+    }
+    return false;
+  });
+}
+
+/**
+ * @brief Swaps to the prefetched file and starts loading the one after.
+ *
+ * @return False if there are no more files.
+ */
+bool MdfPlaylist::NextFile() {
+  if (prefetch_job_.IsRunning()) {
+    ++nof_stalls_;
+    LOG_TRACE() << "Waiting for the next playlist file. Source: " << Name();
+  }
+  prefetch_job_.Wait();
+  if (!next_) {
+    return false;
+  }
+  current_ = std::move(next_);
+  current_index_ = next_index_;
+  current_->Publisher(publisher_);
+  Prefetch(current_index_ + 1);
+  return true;
+}
+
+void MdfPlaylist::Start() {
+  Stop();
+  ISource::Start();
+  if (!started_) {
+    return;
+  }
+  if (!publisher_) {
+    LOG_ERROR() << "The source has no publisher. Source: " << Name();
+    operable_ = false;
+    return;
+  }
+  // A previous replay has moved on from the first file. The first file is
+  // then loaded again by the prefetch job, so the caller isn't blocked.
+  const bool rewind = !current_ || current_index_ != first_index_;
+  if (!rewind) {
+    current_->Publisher(publisher_);
+    if (!prefetch_job_.IsRunning() && !next_) {
+      Prefetch(current_index_ + 1);  // A stop cancelled the prefetch.
+    }
+  }
+  sent_frames_ = 0;
+  nof_stalls_ = 0;
+  clock_.Start(rewind ? 0 : current_->FirstTime());
+  replay_thread_ = std::thread(&MdfPlaylist::ReplayThread, this, rewind);
+}
+
+void MdfPlaylist::Stop() {
+  clock_.Cancel();
+  if (replay_thread_.joinable()) {
+    // The replay thread may wait for the prefetch job in NextFile().
+    prefetch_job_.Cancel();
+    replay_thread_.join();
+    prefetch_job_.Wait();
+  }
+  ISource::Stop();
+}
+
+/**
+ * @brief Publishes the frames of all files paced to their timestamps.
+ *
+ * The clock is started once, so the time between the files is the same as
+ * in the original recording and a file boundary doesn't add any delay.
+ * A rewind waits for the prefetch job to load the first file.
+ */
+void MdfPlaylist::ReplayThread(bool rewind) {
+  if (rewind) {
+    current_.reset();
+    Prefetch(first_index_);
+    if (!NextFile()) {
+      LOG_ERROR() << "Didn't load the first playlist file. Source: "
+        << Name();
+      operable_ = false;
+      return;
+    }
+    nof_stalls_ = 0;  // The rewind isn't a stall.
+    clock_.Anchor(current_->FirstTime());
+  }
+  while (current_ && !clock_.IsCancelled()) {
+    const size_t nof_frames = current_->NofMessages();
+    for (size_t index = 0; index < nof_frames; ++index) {
+      const uint64_t frame_time = current_->GetMessage(index).Timestamp();
+      if (!clock_.WaitUntil(frame_time)) {
+        break;
+      }
+      current_->PublishFrame(index, clock_.WallTime(frame_time));
+      ++sent_frames_;
+    }
+    if (clock_.IsCancelled() || !NextFile()) {
+      break;
+    }
+  }
+  LOG_TRACE() << "Playlist replay ended. Source: " << Name() << ", Frames: "
+    << sent_frames_;
+}
+
+void MdfPlaylist::WriteProperties(IXmlNode& source_node) const {
+  ISource::WriteProperties(source_node);
+  source_node.SetProperty("UseCache", use_cache_);
+  source_node.SetProperty("SpeedFactor", SpeedFactor());
+  filter_.WriteConfig(source_node);
+}
+
+void MdfPlaylist::ReadConfig(const IXmlNode& source_node) {
+  ISource::ReadConfig(source_node);
+  use_cache_ = source_node.Property<bool>("UseCache", true);
+  SpeedFactor(source_node.Property<double>("SpeedFactor", 1.0));
+  filter_.ReadConfig(source_node);
+}
+
+void MdfPlaylist::ToProperties(std::vector<BusProperty>& properties) const {
+  ISource::ToProperties(properties);
+  if (IsEnabling()) {
+    // The enable job owns the source data until it is done.
+    return;
+  }
+  properties.emplace_back();
+  properties.emplace_back("MDF Playlist");
+  properties.emplace_back("Nof Files", std::to_string(file_list_.size()));
+  if (const size_t current = current_index_; current < file_list_.size()) {
+    const path filename(file_list_[current].filename);
+    properties.emplace_back("Current File", filename.filename().string());
+    properties.emplace_back("File Index", std::to_string(current + 1));
+  }
+  properties.emplace_back("Prefetch",
+                          prefetch_job_.IsRunning() ? "Loading" : "Ready");
+  properties.emplace_back("Frame Cache", use_cache_ ? "On" : "Off");
+  filter_.ToProperties(properties);
+
+  properties.emplace_back();
+  properties.emplace_back("Replay");
+  properties.emplace_back("Speed Factor", std::to_string(SpeedFactor()));
+  properties.emplace_back("Frames Sent", std::to_string(sent_frames_));
+  properties.emplace_back("Stalls", std::to_string(nof_stalls_));
+}
+
+}  // namespace bus
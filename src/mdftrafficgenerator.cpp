@@ -5,40 +5,239 @@
 
 #include "bus/mdftrafficgenerator.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <deque>
 #include <filesystem>
 #include <memory>
-#include <functional>
+#include <thread>
 
 #include <util/logstream.h>
+#include <util/ixmlnode.h>
 
 #include <mdf/mdfreader.h>
 #include <mdf/idatagroup.h>
 #include <mdf/ichannelgroup.h>
 #include <mdf/canbusobserver.h>
 #include <bus/candataframe.h>
+#include <bus/canerrorframe.h>
+#include <bus/canoverloadframe.h>
+#include <bus/canremoteframe.h>
+
+#include "bus/framecache.h"
+#include "bus/messagepool.h"
 
 using namespace std::filesystem;
+using namespace std::chrono_literals;
 using namespace util::log;
+using namespace util::xml;
 using namespace mdf;
 
+namespace {
+
+constexpr size_t kMinWindowSize = 1'000;
+constexpr size_t kMinQueueSize = 1'000;
+constexpr size_t kMaxBatchSize = 65'536;
+constexpr auto kBackPressureWait = 100us;
+
+uint64_t NowNs() {
+  using namespace std::chrono;
+  return duration_cast<nanoseconds>(
+      system_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * \brief Converts relative seconds to nanoseconds with correct rounding.
+ *
+ * The whole seconds and the fraction are converted separately. Both parts
+ * are exact in a double, so the result is the nearest nanosecond also for
+ * long measurements. A multiply and cast truncates, so 0.3 s becomes
+ * 299'999'999 ns.
+ */
+int64_t SecondsToNs(double seconds) {
+  if (!std::isfinite(seconds)) {
+    return 0;
+  }
+  const double whole = std::floor(seconds);
+  const double fraction = seconds - whole;
+  return static_cast<int64_t>(whole) * 1'000'000'000
+         + std::llround(fraction * 1'000'000'000.0);
+}
+
+/** \brief Returns true if the bus messages can be read. */
+bool IsSupportedBus(BusType bus_type) {
+  // The MDF library only supplies an observer for CAN (and CAN FD).
+  return bus_type == BusType::Can;
+}
+
+std::string_view BusTypeToString(BusType bus_type) {
+  switch (bus_type) {
+    case BusType::Can: return "CAN";
+    case BusType::Lin: return "LIN";
+    case BusType::Most: return "MOST";
+    case BusType::FlexRay: return "FlexRay";
+    case BusType::Kline: return "K-Line";
+    case BusType::Ethernet: return "Ethernet";
+    case BusType::Usb: return "USB";
+    default:
+      break;
+  }
+  return "Other";
+}
+
+uint16_t MakeFlags(const CanMessage& msg) {
+  using namespace bus;
+  uint16_t flags = 0;
+  const auto set_flag = [&flags] (bool set, uint16_t flag) {
+    if (set) {
+      flags |= flag;
+    }
+  };
+  set_flag(msg.Dir(), CanFrameFlag::Dir);
+  set_flag(msg.Srr(), CanFrameFlag::Srr);
+  set_flag(msg.Edl(), CanFrameFlag::Edl);
+  set_flag(msg.Brs(), CanFrameFlag::Brs);
+  set_flag(msg.Esi(), CanFrameFlag::Esi);
+  set_flag(msg.Rtr(), CanFrameFlag::Rtr);
+  set_flag(msg.WakeUp(), CanFrameFlag::WakeUp);
+  set_flag(msg.SingleWire(), CanFrameFlag::SingleWire);
+  set_flag(msg.R0(), CanFrameFlag::R0);
+  set_flag(msg.R1(), CanFrameFlag::R1);
+  return flags;
+}
+
+/** \brief Sets the ID and flags that data, remote and error frames share. */
+template <typename T>
+void SetFrameProperties(T& bus_msg, const bus::CanFrameView& frame) {
+  using namespace bus;
+  bus_msg.MessageId(frame.MessageId());
+  bus_msg.CanId(frame.CanId());
+  bus_msg.ExtendedId(frame.ExtendedId());
+  bus_msg.Dlc(frame.Dlc());
+  bus_msg.Dir(frame.HasFlag(CanFrameFlag::Dir));
+  bus_msg.Srr(frame.HasFlag(CanFrameFlag::Srr));
+  bus_msg.Edl(frame.HasFlag(CanFrameFlag::Edl));
+  bus_msg.Brs(frame.HasFlag(CanFrameFlag::Brs));
+  bus_msg.Esi(frame.HasFlag(CanFrameFlag::Esi));
+  bus_msg.Rtr(frame.HasFlag(CanFrameFlag::Rtr));
+  bus_msg.WakeUp(frame.HasFlag(CanFrameFlag::WakeUp));
+  bus_msg.SingleWire(frame.HasFlag(CanFrameFlag::SingleWire));
+  bus_msg.R0(frame.HasFlag(CanFrameFlag::R0));
+  bus_msg.R1(frame.HasFlag(CanFrameFlag::R1));
+}
+
+/** \brief Creates a message object in the pool. */
+template <typename T>
+std::shared_ptr<T> MakePoolMessage(
+    const std::shared_ptr<bus::MessagePool>& pool) {
+  return std::allocate_shared<T>(bus::PoolAllocator<T>(pool));
+}
+
+/**
+ * \brief Creates the bus message of a frame.
+ *
+ * The data frames are taken from the ring, so a data frame object is
+ * reused when the broker is done with it. A reused message keeps the
+ * capacity of its data bytes, so the steady state doesn't allocate.
+ */
+std::shared_ptr<bus::IBusMessage> CreateBusMessage(
+    const bus::CanFrameView& frame, uint64_t timestamp,
+    const std::shared_ptr<bus::MessagePool>& pool,
+    bus::MessageRing<bus::CanDataFrame>& data_frame_ring) {
+  using namespace bus;
+  // The data bytes are copied into the message, so the temporary vector
+  // is reused for all messages in the thread.
+  thread_local std::vector<uint8_t> data_bytes;
+  const auto data = frame.DataBytes();
+  data_bytes.assign(data.begin(), data.end());
+
+  std::shared_ptr<IBusMessage> bus_msg;
+  switch (frame.Type()) {
+    case CanFrameType::RemoteFrame: {
+      auto remote_frame = MakePoolMessage<CanRemoteFrame>(pool);
+      SetFrameProperties(*remote_frame, frame);
+      bus_msg = remote_frame;
+      break;
+    }
+
+    case CanFrameType::ErrorFrame: {
+      auto error_frame = MakePoolMessage<CanErrorFrame>(pool);
+      SetFrameProperties(*error_frame, frame);
+      error_frame->DataLength(data.size());
+      error_frame->DataBytes(data_bytes);
+      error_frame->ErrorBitPosition(frame.BitPosition());
+      error_frame->ErrorType(
+          static_cast<bus::CanErrorType>(frame.ErrorType()));
+      bus_msg = error_frame;
+      break;
+    }
+
+    case CanFrameType::OverloadFrame: {
+      auto overload_frame = MakePoolMessage<CanOverloadFrame>(pool);
+      overload_frame->Dir(frame.HasFlag(CanFrameFlag::Dir));
+      bus_msg = overload_frame;
+      break;
+    }
+
+    case CanFrameType::DataFrame:
+    default: {
+      auto data_frame = data_frame_ring.Next(pool);
+      SetFrameProperties(*data_frame, frame);
+      data_frame->DataLength(data.size());
+      data_frame->DataBytes(data_bytes);
+      bus_msg = data_frame;
+      break;
+    }
+  }
+  bus_msg->Timestamp(timestamp);
+  bus_msg->BusChannel(frame.BusChannel());
+  return bus_msg;
+}
+
+}  // namespace
+
 namespace bus {
 
-MdfTrafficGenerator::MdfTrafficGenerator() {
+MdfTrafficGenerator::MdfTrafficGenerator()
+    : message_pool_(std::make_shared<MessagePool>()) {
   type_ = TypeOfSource::Mdf;
 }
 
-void MdfTrafficGenerator::Enable(bool enable) {
+MdfTrafficGenerator::~MdfTrafficGenerator() {
+  CancelEnable();
+  MdfTrafficGenerator::Stop();
+  CloseStream();
+}
 
+void MdfTrafficGenerator::Enable(bool enable) {
+  Stop();
   enabled_ = false;
   operable_ = false;
+  CloseStream();
+  frame_store_.Clear();
+  frame_store_.ShrinkToFit();
+  compressed_store_.Clear();
+  statistics_.Clear();
+  // Queued messages keep the old pool until they are consumed.
+  message_pool_ = std::make_shared<MessagePool>();
+  data_frame_ring_.Clear();
+  bus_list_.clear();
+  nof_unsupported_groups_ = 0;
+  if (!enable) {
+    return;
+  }
+
   const bool check = CheckMdfFile();
   if (!check) {
     LOG_ERROR() << "Didn't enable the task. Name: " << Name();
     return;
   }
-  const bool read = ReadMdfFile();
+  const bool read = streaming_ ? OpenStream() && ReadWindow() : ReadMdfFile();
   if (!read) {
     LOG_ERROR() << "Didn't read the MDF file. File: " << Filename();
+    CloseStream();
     return;
   }
   enabled_ = true;
@@ -46,6 +245,18 @@ void MdfTrafficGenerator::Enable(bool enable) {
 
 }
 
+void MdfTrafficGenerator::WindowSize(size_t nof_messages) {
+  window_size_ = std::max(nof_messages, kMinWindowSize);
+}
+
+void MdfTrafficGenerator::BatchSize(size_t batch_size) {
+  batch_size_ = std::clamp<size_t>(batch_size, 1, kMaxBatchSize);
+}
+
+void MdfTrafficGenerator::MaxQueueSize(size_t max_size) {
+  max_queue_size_ = std::max(max_size, kMinQueueSize);
+}
+
 bool MdfTrafficGenerator::CheckMdfFile() {
   try {
     path fullname(Filename());
@@ -67,8 +278,18 @@ bool MdfTrafficGenerator::CheckMdfFile() {
 }
 
 bool MdfTrafficGenerator::ReadMdfFile() {
+  // The decoded and sorted frames are cached next to the MDF file. A valid
+  // cache is memory mapped instead of reading the MDF file.
+  const FrameCache cache(Filename(), filter_.Hash());
+  if (use_cache_ && cache.Load(frame_store_, start_time_)) {
+    LOG_TRACE() << "Mapped " << frame_store_.Size()
+      << " CAN messages from the cache. File: " << cache.CacheFile();
+    statistics_.Compute(frame_store_);
+    CompressFrames();
+    return true;
+  }
   try {
-    message_list_.clear();
+    frame_store_.Clear();
     MdfReader reader(Filename());
     const bool read_meta_data = reader.ReadEverythingButData();
     if (!read_meta_data) {
@@ -91,39 +312,106 @@ bool MdfTrafficGenerator::ReadMdfFile() {
     start_time_ = header->StartTime();
     DataGroupList dg_list;
     mdf_file->DataGroups(dg_list);
-    for (IDataGroup* data_group : dg_list) {
+
+    // Only data groups with supported bus traffic are read. A data group
+    // is read in one pass, even if it holds several bus types. The number
+    // of samples is used as progress.
+    std::vector<size_t> job_list;
+    std::vector<uint64_t> sample_list;
+    uint64_t nof_samples = 0;
+    for (size_t dg_index = 0; dg_index < dg_list.size(); ++dg_index) {
+      const auto* data_group = dg_list[dg_index];
       if (data_group == nullptr) {
         continue;
       }
-      std::vector<std::unique_ptr<CanBusObserver>> observer_list;
+      uint64_t dg_samples = 0;
       for (const auto* channel_group : data_group->ChannelGroups()) {
-        if (channel_group == nullptr ||
-            (channel_group->Flags() & CgFlag::VlsdChannel) != 0 ||
-            (channel_group->Flags() & CgFlag::BusEvent) == 0 ||
-            channel_group->GetBusType() != TypeOfBus()||
-            channel_group->NofSamples() == 0) {
-          continue;
+        if (channel_group != nullptr && AddTrafficGroup(*channel_group)) {
+          dg_samples += channel_group->NofSamples();
         }
-        auto observer = std::make_unique<CanBusObserver>(*data_group,
-                                                         *channel_group);
-        observer->OnCanMessage = std::bind(
-            &MdfTrafficGenerator::CanMessageCallback, this,
-            std::placeholders::_1, std::placeholders::_2);
-        observer_list.emplace_back(std::move(observer));
-      }
-      if (observer_list.empty()) {
-        continue;
       }
-      const bool data = reader.ReadData(*data_group);
-      if (!data) {
-        throw std::runtime_error(
-            "Didn't read the CAN message data block. File: " + Filename());
+      if (dg_samples > 0) {
+        job_list.push_back(dg_index);
+        sample_list.push_back(dg_samples);
+        nof_samples += dg_samples;
+      }
+    }
+    enable_job_.Progress(0, nof_samples);
+
+    // Each data group is read by a worker thread with its own reader. Each
+    // channel group is stored in its own time-ordered stream. The streams
+    // are merged by time when all data groups have been read.
+    std::vector<std::deque<FrameStream>> result_list(job_list.size());
+    std::vector<std::string> error_list(job_list.size());
+    std::atomic<size_t> next_job = 0;
+    std::atomic<uint64_t> samples_read = 0;
+    const auto worker = [&] () {
+      std::unique_ptr<MdfReader> worker_reader;
+      for (size_t job = next_job++; job < job_list.size(); job = next_job++) {
+        if (enable_job_.IsCancelled()) {
+          break;
+        }
+        try {
+          if (!worker_reader) {
+            worker_reader = std::make_unique<MdfReader>(Filename());
+            if (!worker_reader->ReadEverythingButData()) {
+              throw std::runtime_error("Didn't read the meta-data.");
+            }
+          }
+          ReadDataGroup(*worker_reader, job_list[job], result_list[job]);
+        } catch (const std::exception& err) {
+          error_list[job] = err.what();
+        }
+        samples_read += sample_list[job];
+        enable_job_.Progress(samples_read, nof_samples);
+      }
+    };
+
+    const size_t nof_workers = std::min<size_t>(
+        job_list.size(), std::max(std::thread::hardware_concurrency(), 1U));
+    if (nof_workers <= 1) {
+      worker();
+    } else {
+      std::vector<std::thread> worker_list;
+      for (size_t index = 0; index < nof_workers; ++index) {
+        worker_list.emplace_back(worker);
+      }
+      for (auto& worker_thread : worker_list) {
+        worker_thread.join();
       }
+    }
 
+    if (enable_job_.IsCancelled()) {
+      throw std::runtime_error("The read was cancelled.");
+    }
+    for (const auto& error : error_list) {
+      if (!error.empty()) {
+        throw std::runtime_error(error);
+      }
     }
 
-    LOG_TRACE() << "Stored " << message_list_.size() << " CAN messages.";
-    std::sort(message_list_.begin(), message_list_.end(), LessTime);
+    std::vector<CanFrameStore*> merge_list;
+    bool exact_statistics = true;
+    for (auto& stream_list : result_list) {
+      for (auto& stream : stream_list) {
+        merge_list.push_back(&stream.frames);
+        if (!statistics_.Merge(stream.statistics)) {
+          exact_statistics = false;
+        }
+      }
+    }
+    frame_store_.Merge(merge_list);
+    if (!exact_statistics) {
+      // An ID is interleaved in several streams, so its periods are only
+      // known from the merged stream.
+      statistics_.Compute(frame_store_);
+    }
+    LOG_TRACE() << "Stored " << frame_store_.Size() << " CAN messages. Size: "
+      << frame_store_.MemorySize() << " bytes, Threads: " << nof_workers;
+    if (use_cache_ && cache.Save(frame_store_, start_time_)) {
+      LOG_TRACE() << "Saved the frame cache. File: " << cache.CacheFile();
+    }
+    CompressFrames();
   } catch (const std::exception& err) {
     LOG_ERROR() << "Didn't read the file. Error: " << err.what()
       << ", File: " << Filename();
@@ -132,71 +420,750 @@ bool MdfTrafficGenerator::ReadMdfFile() {
   return true;
 }
 
-bool MdfTrafficGenerator::CanMessageCallback(uint64_t ,
-                                             const mdf::CanMessage& msg) {
-  AddCanMessage(msg);
+/**
+ * @brief Moves the frames into the compressed store.
+ *
+ * The uncompressed store is released, so only the compressed frames and
+ * a few decoded blocks are held in memory.
+ */
+void MdfTrafficGenerator::CompressFrames() {
+  if (!compress_ || streaming_ || frame_store_.Empty()) {
+    return;
+  }
+  compressed_store_.Compress(frame_store_);
+  frame_store_.Clear();
+  frame_store_.ShrinkToFit();
+  LOG_TRACE() << "Compressed " << compressed_store_.Size()
+    << " CAN messages. Size: " << compressed_store_.MemorySize()
+    << " bytes, Uncompressed: " << compressed_store_.RawSize() << " bytes";
+}
+
+void MdfTrafficGenerator::ReadDataGroup(
+    MdfReader& reader, size_t dg_index,
+    std::deque<FrameStream>& stream_list) const {
+  const auto* mdf_file = reader.GetFile();
+  if (mdf_file == nullptr) {
+    throw std::runtime_error("Didn't find any MDF file. File: " + Filename());
+  }
+  DataGroupList dg_list;
+  mdf_file->DataGroups(dg_list);
+  if (dg_index >= dg_list.size() || dg_list[dg_index] == nullptr) {
+    throw std::runtime_error("Didn't find the data group. File: "
+                             + Filename());
+  }
+  auto* data_group = dg_list[dg_index];
+
+  // All bus channel groups in the data group are observed at the same
+  // time, so the data blocks are only read once.
+  std::vector<std::unique_ptr<CanBusObserver>> observer_list;
+  for (const auto* channel_group : data_group->ChannelGroups()) {
+    if (channel_group == nullptr || !IsTrafficGroup(*channel_group) ||
+        !IsSupportedBus(channel_group->GetBusType())) {
+      continue;
+    }
+    auto& stream = stream_list.emplace_back();
+    if (!filter_.IsActive()) {
+      // Classic CAN frames have at most 8 data bytes.
+      stream.frames.Reserve(channel_group->NofSamples(),
+                            channel_group->NofSamples() * 8);
+    }
+    auto observer = std::make_unique<CanBusObserver>(*data_group,
+                                                     *channel_group);
+    // The statistics are updated in the same pass as the frames are read.
+    observer->OnCanMessage = [this, stream = &stream] (uint64_t,
+                                  const CanMessage& msg) -> bool {
+      if (enable_job_.IsCancelled()) {
+        return false;
+      }
+      if (AddCanMessage(msg, stream->frames)) {
+        stream->statistics.Add(stream->frames.At(stream->frames.Size() - 1));
+      }
+      return true;
+    };
+    observer_list.emplace_back(std::move(observer));
+  }
+  if (observer_list.empty()) {
+    return;
+  }
+  const bool data = reader.ReadData(*data_group);
+  if (!data) {
+    throw std::runtime_error(
+        "Didn't read the CAN message data block. File: " + Filename());
+  }
+}
+
+bool MdfTrafficGenerator::IsTrafficGroup(
+    const IChannelGroup& channel_group) const {
+  return (channel_group.Flags() & CgFlag::VlsdChannel) == 0 &&
+         (channel_group.Flags() & CgFlag::BusEvent) != 0 &&
+         channel_group.NofSamples() > 0;
+}
+
+/**
+ * @brief Registers the bus type of a traffic channel group.
+ *
+ * @return True if the channel group is a traffic group that can be read.
+ */
+bool MdfTrafficGenerator::AddTrafficGroup(const IChannelGroup& channel_group) {
+  if (!IsTrafficGroup(channel_group)) {
+    return false;
+  }
+  const BusType bus_type = channel_group.GetBusType();
+  if (std::ranges::find(bus_list_, bus_type) == bus_list_.end()) {
+    bus_list_.push_back(bus_type);
+  }
+  if (!IsSupportedBus(bus_type)) {
+    LOG_TRACE() << "No reader for the bus type. Bus: "
+      << BusTypeToString(bus_type) << ", Group: " << channel_group.Name()
+      << ", File: " << Filename();
+    ++nof_unsupported_groups_;
+    return false;
+  }
   return true;
 }
 
-bool MdfTrafficGenerator::LessTime(
-    const std::unique_ptr<IBusMessage>& msg1,
-    const std::unique_ptr<IBusMessage>& msg2) {
-  if (!msg1 && !msg2) {
+bool MdfTrafficGenerator::OpenStream() {
+  CloseStream();
+  try {
+    stream_reader_ = std::make_unique<MdfReader>(Filename());
+    const bool read_meta_data = stream_reader_->ReadEverythingButData();
+    if (!read_meta_data) {
+      throw std::runtime_error(
+          "Didn't find any meta-data in the file. File: " + Filename() );
+    }
+
+    const auto* mdf_file = stream_reader_->GetFile();
+    if (mdf_file == nullptr) {
+      throw std::runtime_error("Didn't find any MDF file. File: "
+                               + Filename());
+    }
+
+    const auto* header = mdf_file->Header();
+    if (header == nullptr) {
+      throw std::runtime_error("Didn't find any header block. File: "
+                               + Filename());
+    }
+    start_time_ = header->StartTime();
+
+    // The data blocks are not read here. Each channel group gets a cursor
+    // that keeps track of the next sample to read.
+    DataGroupList dg_list;
+    mdf_file->DataGroups(dg_list);
+    for (IDataGroup* data_group : dg_list) {
+      if (data_group == nullptr) {
+        continue;
+      }
+      for (const auto* channel_group : data_group->ChannelGroups()) {
+        if (channel_group == nullptr || !AddTrafficGroup(*channel_group)) {
+          continue;
+        }
+        StreamCursor cursor;
+        cursor.data_group = data_group;
+        cursor.channel_group = channel_group;
+        cursor.nof_samples = channel_group->NofSamples();
+        cursor_list_.emplace_back(cursor);
+      }
+    }
+    window_offset_ = 0;
+  } catch (const std::exception& err) {
+    LOG_ERROR() << "Didn't open the file stream. Error: " << err.what()
+      << ", File: " << Filename();
     return false;
   }
-  if (!msg1 && msg2) {
-    return true;
+  return true;
+}
+
+void MdfTrafficGenerator::CloseStream() {
+  cursor_list_.clear();
+  window_mark_list_.clear();
+  stream_reader_.reset();
+  window_offset_ = 0;
+}
+
+void MdfTrafficGenerator::StreamCursor::ClearCandidates(uint64_t sample) {
+  frames.Clear();
+  samples.clear();
+  next_frame = 0;
+  read_sample = sample;
+}
+
+/**
+ * @brief Reads the next block of samples of a channel group.
+ *
+ * Up to window size samples are read. Blocks without any stored frames
+ * are skipped until a frame is found or the channel group ends.
+ */
+void MdfTrafficGenerator::ReadCandidates(StreamCursor& cursor) {
+  cursor.ClearCandidates(cursor.read_sample);
+  while (cursor.samples.empty() && cursor.read_sample < cursor.nof_samples) {
+    const uint64_t first_sample = cursor.read_sample;
+    const uint64_t last_sample = std::min(first_sample + window_size_,
+                                          cursor.nof_samples) - 1;
+    CanBusObserver observer(*cursor.data_group, *cursor.channel_group);
+    observer.OnCanMessage = [&] (uint64_t sample,
+                                 const CanMessage& msg) -> bool {
+      if (sample < first_sample) {
+        return true;
+      }
+      if (sample > last_sample) {
+        return false;
+      }
+      if (AddCanMessage(msg, cursor.frames)) {
+        cursor.samples.push_back(sample);
+      }
+      return true;
+    };
+    const bool data = stream_reader_->ReadPartialData(*cursor.data_group,
+                                                     first_sample,
+                                                     last_sample);
+    if (!data) {
+      throw std::runtime_error(
+          "Didn't read the CAN message data block. File: " + Filename());
+    }
+    cursor.read_sample = last_sample + 1;
   }
-  if (msg1 && !msg2) {
+}
+
+/**
+ * @brief Reads the next window of CAN messages.
+ *
+ * The channel groups are time-ordered but interleaved with each other.
+ * Each channel group reads blocks of up to window size samples as
+ * candidates, and the candidates are merged by time into the window. A
+ * channel group reads its next block when its candidates are used up.
+ * The unused candidates are kept by the cursor for the next window, so
+ * each sample is only read once. The memory is bounded by the number of
+ * channel groups times the window size.
+ *
+ * @return True if the read was successful.
+ */
+bool MdfTrafficGenerator::ReadWindow() {
+  frame_store_.Clear();
+  if (!stream_reader_) {
     return false;
   }
-  return msg1->Timestamp() < msg2->Timestamp();
-}
-
-void MdfTrafficGenerator::AddCanMessage(const CanMessage& msg) {
-  switch (msg.TypeOfMessage()) {
-    case MessageType::CAN_DataFrame: {
-      auto bus_msg = std::make_unique<CanDataFrame>();
-      // The CAN message timestamp unit is seconds and might be a negative
-      // value.
-      int64_t rel_time = static_cast<int64_t>(msg.Timestamp() * 1'000'000'000);
-      bus_msg->Timestamp(start_time_ + rel_time);
-      bus_msg->BusChannel(msg.BusChannel());
-      bus_msg->MessageId(msg.MessageId());
-      bus_msg->CanId(msg.CanId());
-      bus_msg->ExtendedId(msg.ExtendedId());
-      bus_msg->Dlc(msg.Dlc());
-      bus_msg->Crc(msg.Crc());
-      bus_msg->DataLength(msg.DataLength());
-      bus_msg->DataBytes(msg.DataBytes());
-      bus_msg->Dir(msg.Dir());
-      bus_msg->Srr(msg.Srr());
-      bus_msg->Edl(msg.Edl());
-      bus_msg->Brs(msg.Brs());
-      bus_msg->Esi(msg.Esi());
-      bus_msg->Rtr(msg.Rtr());
-      bus_msg->WakeUp(msg.WakeUp());
-      bus_msg->SingleWire(msg.SingleWire());
-      bus_msg->R0(msg.R0());
-      bus_msg->R1(msg.R1());
-      bus_msg->FrameDuration(msg.FrameDuration());
-      message_list_.emplace_back(std::move(bus_msg));
+
+  try {
+    std::vector<uint64_t> start_list;
+    start_list.reserve(cursor_list_.size());
+    for (auto& cursor : cursor_list_) {
+      start_list.push_back(cursor.next_sample);
+      // A seek or rewind has moved the cursor, so the candidates are read
+      // again from the new position.
+      if (cursor.Position() != cursor.next_sample) {
+        cursor.ClearCandidates(cursor.next_sample);
+      }
+    }
+
+    while (frame_store_.Size() < window_size_) {
+      StreamCursor* next = nullptr;
+      for (auto& cursor : cursor_list_) {
+        if (!cursor.HasCandidates()) {
+          ReadCandidates(cursor);
+          if (!cursor.HasCandidates()) {
+            continue;
+          }
+        }
+        if (next == nullptr ||
+            cursor.frames.Timestamp(cursor.next_frame) <
+            next->frames.Timestamp(next->next_frame)) {
+          next = &cursor;
+        }
+      }
+      if (next == nullptr) {
+        break;
+      }
+      frame_store_.Add(next->frames.At(next->next_frame));
+      ++next->next_frame;
+    }
+
+    for (auto& cursor : cursor_list_) {
+      cursor.next_sample = cursor.Position();
+    }
+    MarkWindow(std::move(start_list));
+  } catch (const std::exception& err) {
+    LOG_ERROR() << "Didn't read the stream window. Error: " << err.what()
+      << ", File: " << Filename();
+    frame_store_.Clear();
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Remembers where the current window starts.
+ *
+ * The marks are added in window order, the first time a window is read.
+ * A seek can then jump directly to a window that already has been read.
+ */
+void MdfTrafficGenerator::MarkWindow(std::vector<uint64_t> sample_list) {
+  if (frame_store_.Empty()) {
+    return;
+  }
+  if (!window_mark_list_.empty() &&
+      window_mark_list_.back().window_offset >= window_offset_) {
+    return;
+  }
+  WindowMark mark;
+  mark.first_time = frame_store_.Timestamp(0);
+  mark.window_offset = window_offset_;
+  mark.sample_list = std::move(sample_list);
+  window_mark_list_.emplace_back(std::move(mark));
+}
+
+bool MdfTrafficGenerator::IsLastWindow() const {
+  return std::ranges::all_of(cursor_list_, [] (const auto& cursor) -> bool {
+    return cursor.next_sample >= cursor.nof_samples;
+  });
+}
+
+bool MdfTrafficGenerator::NextWindow() {
+  if (!streaming_ || !stream_reader_) {
+    return false;
+  }
+  // A window may be empty if a channel group only had frames that are not
+  // stored. Continue until something is found or the file ends.
+  while (!IsLastWindow()) {
+    window_offset_ += frame_store_.Size();
+    if (!ReadWindow()) {
+      return false;
     }
+    if (!frame_store_.Empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool MdfTrafficGenerator::RewindWindow() {
+  if (!streaming_ || !stream_reader_) {
+    return false;
+  }
+  for (auto& cursor : cursor_list_) {
+    cursor.next_sample = 0;
+  }
+  window_offset_ = 0;
+  return ReadWindow();
+}
+
+size_t MdfTrafficGenerator::SeekTime(uint64_t time) {
+  if (!streaming_) {
+    return IsCompressed() ? compressed_store_.LowerBound(time)
+                          : frame_store_.LowerBound(time);
+  }
+  if (!stream_reader_ || replay_thread_.joinable()) {
+    return NofMessages();
+  }
+  const bool in_window = !frame_store_.Empty() &&
+      frame_store_.Timestamp(0) <= time &&
+      time <= frame_store_.Timestamp(frame_store_.Size() - 1);
+  if (!in_window) {
+    // Jump to the last known window that starts before the time, then
+    // read forward until the window holds the time.
+    const auto itr = std::ranges::upper_bound(window_mark_list_, time, {},
+                                              &WindowMark::first_time);
+    if (itr == window_mark_list_.cbegin()) {
+      if (window_offset_ > 0 && !RewindWindow()) {
+        return NofMessages();
+      }
+    } else if (const auto& mark = *std::prev(itr);
+               mark.window_offset != window_offset_) {
+      for (size_t index = 0; index < cursor_list_.size() &&
+           index < mark.sample_list.size(); ++index) {
+        cursor_list_[index].next_sample = mark.sample_list[index];
+      }
+      window_offset_ = mark.window_offset;
+      if (!ReadWindow()) {
+        return NofMessages();
+      }
+    }
+    while (!frame_store_.Empty() &&
+           frame_store_.Timestamp(frame_store_.Size() - 1) < time) {
+      if (!NextWindow()) {
+        return NofMessages();
+      }
+    }
+  }
+  return frame_store_.LowerBound(time);
+}
+
+bool MdfTrafficGenerator::AddCanMessage(const CanMessage& msg,
+                                        CanFrameStore& store) const {
+  // The filter is tested before anything is stored. Error and overload
+  // frames are kept by an ID filter, as bus errors matter in a replay.
+  const MessageType type = msg.TypeOfMessage();
+  const bool has_id = type != MessageType::CAN_ErrorFrame &&
+                      type != MessageType::CAN_OverloadFrame;
+  if (!filter_.Match(msg.BusChannel(), msg.CanId(), msg.ExtendedId(),
+                     msg.Timestamp(), has_id)) {
+    return false;
+  }
+  uint16_t flags = MakeFlags(msg);
+  uint16_t bit_position = 0;
+  switch (type) {
+    case MessageType::CAN_DataFrame:
+      flags = TagFrameFlags(flags, CanFrameType::DataFrame);
+      break;
+
+    case MessageType::CAN_RemoteFrame:
+      flags = TagFrameFlags(flags, CanFrameType::RemoteFrame);
+      break;
 
     case MessageType::CAN_ErrorFrame:
+      flags = TagFrameFlags(flags, CanFrameType::ErrorFrame,
+                            static_cast<uint8_t>(msg.ErrorType()));
+      bit_position = msg.BitPosition();
+      break;
+
     case MessageType::CAN_OverloadFrame:
-    case MessageType::CAN_RemoteFrame:
-    default:
+      flags = TagFrameFlags(flags, CanFrameType::OverloadFrame);
       break;
+
+    default:
+      return false;
   }
+  // The CAN message timestamp unit is seconds and might be a negative
+  // value.
+  const int64_t rel_time = SecondsToNs(msg.Timestamp());
+  store.Add(start_time_ + rel_time, msg.MessageId(), msg.BusChannel(),
+            msg.Dlc(), flags, msg.DataBytes(), bit_position);
+  return true;
 }
 
-const IBusMessage* MdfTrafficGenerator::GetMessage(size_t index) const {
-  return index < message_list_.size() ? message_list_[index].get() : nullptr;
+CanFrameView MdfTrafficGenerator::GetMessage(size_t index) const {
+  return IsCompressed() ? compressed_store_.At(index) : frame_store_.At(index);
 }
 
 uint64_t MdfTrafficGenerator::FirstTime() const {
-  return message_list_.empty() ? 0 : message_list_[0]->Timestamp();
+  if (IsCompressed()) {
+    return compressed_store_.FirstTime();
+  }
+  return frame_store_.Empty() ? 0 : frame_store_.Timestamp(0);
+}
+
+uint64_t MdfTrafficGenerator::LastTime() const {
+  if (IsCompressed()) {
+    return compressed_store_.LastTime();
+  }
+  return frame_store_.Empty() ? 0 :
+      frame_store_.Timestamp(frame_store_.Size() - 1);
+}
+
+void MdfTrafficGenerator::Start() {
+  Stop();
+  ISource::Start();
+  if (!started_) {
+    return;
+  }
+  if (!publisher_) {
+    LOG_ERROR() << "The source has no publisher. Source: " << Name();
+    operable_ = false;
+    return;
+  }
+  size_t index = 0;
+  if (replay_start_ > 0) {
+    index = SeekTime(replay_start_);
+  } else if (streaming_ && window_offset_ > 0 && !RewindWindow()) {
+    LOG_ERROR() << "Didn't rewind the stream. Source: " << Name();
+    operable_ = false;
+    return;
+  }
+  start_index_ = index;
+  clock_.Start(index < NofMessages() ?
+               GetMessage(index).Timestamp() : FirstTime());
+  sent_frames_ = 0;
+  sent_bytes_ = 0;
+  send_time_ = 0;
+  nof_loops_ = 0;
+  if (external_clock_) {
+    return;
+  }
+  switch (replay_mode_) {
+    case TypeOfReplay::Firehose:
+      replay_thread_ = std::thread(&MdfTrafficGenerator::FirehoseThread, this,
+                                   index);
+      break;
+
+    case TypeOfReplay::RealTime:
+    default:
+      replay_thread_ = std::thread(&MdfTrafficGenerator::ReplayThread, this,
+                                   index);
+      break;
+  }
+}
+
+void MdfTrafficGenerator::PublishFrame(size_t index, uint64_t send_time) {
+  if (!publisher_ || index >= NofMessages()) {
+    return;
+  }
+  const CanFrameView frame = GetMessage(index);
+  publisher_->Push(CreateBusMessage(frame, send_time, message_pool_,
+                                    data_frame_ring_));
+  ++sent_frames_;
+  sent_bytes_ += frame.DataLength();
+}
+
+void MdfTrafficGenerator::Stop() {
+  clock_.Cancel();
+  if (replay_thread_.joinable()) {
+    replay_thread_.join();
+  }
+  ISource::Stop();
+}
+
+/**
+ * @brief Moves the replay to the next window or to the start of the file.
+ *
+ * In loop mode, the replay wraps around to the first frame. The loop offset
+ * is added to the frame timestamps, so the next iteration continues after
+ * the last frame and the loop gap. Only a streaming source needs to read
+ * its windows again.
+ *
+ * @return False if the replay is done.
+ */
+bool MdfTrafficGenerator::NextReplayFrames(size_t& index,
+                                           uint64_t& loop_offset) {
+  if (streaming_ && NextWindow()) {
+    index = 0;
+    return true;
+  }
+  if (!loop_ || NofMessages() == 0) {
+    return false;
+  }
+  const uint64_t last_time = LastTime();
+  if (streaming_ && !RewindWindow()) {
+    return false;
+  }
+  loop_offset += last_time + loop_gap_ - FirstTime();
+  index = 0;
+  ++nof_loops_;
+  return true;
+}
+
+/**
+ * @brief Publishes the frames paced to their original timestamps.
+ *
+ * In streaming mode, the replay thread moves the window when it reaches
+ * its end. The published frames are time-stamped with the time they are
+ * sent.
+ */
+void MdfTrafficGenerator::ReplayThread(size_t index) {
+  uint64_t loop_offset = 0;
+  while (!clock_.IsCancelled()) {
+    if (index >= NofMessages()) {
+      if (NextReplayFrames(index, loop_offset)) {
+        continue;
+      }
+      break;
+    }
+    const CanFrameView frame = GetMessage(index);
+    const uint64_t frame_time = frame.Timestamp() + loop_offset;
+    if (!clock_.WaitUntil(frame_time)) {
+      break;
+    }
+    const uint64_t send_time = clock_.WallTime(frame_time);
+    publisher_->Push(CreateBusMessage(frame, send_time, message_pool_,
+                                    data_frame_ring_));
+    ++sent_frames_;
+    sent_bytes_ += frame.DataLength();
+    ++index;
+  }
+  LOG_TRACE() << "Replay ended. Source: " << Name() << ", Frames: "
+    << clock_.NofFrames();
+}
+
+/**
+ * @brief Publishes the frames as fast as possible.
+ *
+ * The messages are created and pushed in batches. If the publisher queue
+ * grows above the max queue size, the thread waits until the broker has
+ * consumed half of the queue. The throughput is then limited by the broker.
+ */
+void MdfTrafficGenerator::FirehoseThread(size_t index) {
+  std::vector<std::shared_ptr<IBusMessage>> batch;
+  batch.reserve(batch_size_);
+  const auto start = std::chrono::steady_clock::now();
+  const auto update_time = [&] () {
+    send_time_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+  };
+  uint64_t loop_offset = 0;  // Not used as the frames are not paced.
+
+  while (!clock_.IsCancelled()) {
+    if (index >= NofMessages()) {
+      if (NextReplayFrames(index, loop_offset)) {
+        continue;
+      }
+      break;
+    }
+
+    if (publisher_->Size() >= max_queue_size_) {
+      while (publisher_->Size() > max_queue_size_ / 2 &&
+             !clock_.IsCancelled()) {
+        std::this_thread::sleep_for(kBackPressureWait);
+      }
+      continue;
+    }
+
+    batch.clear();
+    uint64_t nof_bytes = 0;
+    const uint64_t send_time = NowNs();
+    const size_t last = std::min(index + batch_size_, NofMessages());
+    for (; index < last; ++index) {
+      const CanFrameView frame = GetMessage(index);
+      nof_bytes += frame.DataLength();
+      batch.emplace_back(CreateBusMessage(frame, send_time, message_pool_,
+                                          data_frame_ring_));
+    }
+    for (auto& msg : batch) {
+      publisher_->Push(msg);
+    }
+    sent_frames_ += batch.size();
+    sent_bytes_ += nof_bytes;
+    update_time();
+  }
+  update_time();
+  LOG_TRACE() << "Firehose replay ended. Source: " << Name() << ", Frames: "
+    << sent_frames_;
+}
+
+void MdfTrafficGenerator::WriteProperties(IXmlNode& source_node) const {
+  ISource::WriteProperties(source_node);
+  source_node.SetProperty("UseCache", use_cache_);
+  source_node.SetProperty("Compress", compress_);
+  source_node.SetProperty("BitRate", bit_rate_);
+  source_node.SetProperty("Streaming", streaming_);
+  source_node.SetProperty("WindowSize", window_size_);
+  source_node.SetProperty("SpeedFactor", SpeedFactor());
+  source_node.SetProperty("TimeOffset", time_offset_);
+  source_node.SetProperty("Loop", loop_);
+  source_node.SetProperty("LoopGap", loop_gap_);
+  source_node.SetProperty("ReplayMode", static_cast<int>(replay_mode_));
+  source_node.SetProperty("BatchSize", batch_size_);
+  source_node.SetProperty("MaxQueueSize", max_queue_size_);
+  filter_.WriteConfig(source_node);
+}
+
+void MdfTrafficGenerator::ReadConfig(const IXmlNode& source_node) {
+  ISource::ReadConfig(source_node);
+  use_cache_ = source_node.Property<bool>("UseCache", true);
+  compress_ = source_node.Property<bool>("Compress", false);
+  bit_rate_ = source_node.Property<uint64_t>("BitRate", 500'000);
+  streaming_ = source_node.Property<bool>("Streaming", false);
+  WindowSize(source_node.Property<size_t>("WindowSize", 100'000));
+  SpeedFactor(source_node.Property<double>("SpeedFactor", 1.0));
+  time_offset_ = source_node.Property<int64_t>("TimeOffset", 0);
+  loop_ = source_node.Property<bool>("Loop", false);
+  loop_gap_ = source_node.Property<uint64_t>("LoopGap", 1'000'000);
+  replay_mode_ = static_cast<TypeOfReplay>(
+      source_node.Property<int>("ReplayMode", 0));
+  BatchSize(source_node.Property<size_t>("BatchSize", 1'024));
+  MaxQueueSize(source_node.Property<size_t>("MaxQueueSize", 100'000));
+  filter_.ReadConfig(source_node);
+}
+
+void MdfTrafficGenerator::ToProperties(
+    std::vector<BusProperty>& properties) const {
+  ISource::ToProperties(properties);
+  if (IsEnabling()) {
+    // The enable job owns the source data until it is done.
+    return;
+  }
+  properties.emplace_back();
+  properties.emplace_back("MDF Traffic");
+  properties.emplace_back("Streaming", streaming_ ? "Yes" : "No");
+  if (!streaming_) {
+    properties.emplace_back("Frame Cache", !use_cache_ ? "Off" :
+                            frame_store_.IsMapped() ? "Mapped" : "On");
+    properties.emplace_back("Compressed", IsCompressed() ? "Yes" : "No");
+  }
+  if (streaming_) {
+    properties.emplace_back("Window Size", std::to_string(window_size_));
+    properties.emplace_back("Window Offset", std::to_string(window_offset_));
+    properties.emplace_back("Known Windows",
+                            std::to_string(window_mark_list_.size()));
+  }
+  if (!bus_list_.empty()) {
+    std::string bus_types;
+    for (const BusType bus_type : bus_list_) {
+      if (!bus_types.empty()) {
+        bus_types += ", ";
+      }
+      bus_types += BusTypeToString(bus_type);
+    }
+    properties.emplace_back("Bus Types", bus_types);
+  }
+  if (nof_unsupported_groups_ > 0) {
+    properties.emplace_back("Unsupported Groups",
+                            std::to_string(nof_unsupported_groups_));
+  }
+  properties.emplace_back("Nof Messages", std::to_string(NofMessages()));
+  if (IsCompressed()) {
+    properties.emplace_back("Memory Size",
+                            std::to_string(compressed_store_.MemorySize()),
+                            "bytes");
+    properties.emplace_back("Uncompressed Size",
+                            std::to_string(compressed_store_.RawSize()),
+                            "bytes");
+  } else {
+    properties.emplace_back("Memory Size",
+                            std::to_string(frame_store_.MemorySize()),
+                            "bytes");
+  }
+  filter_.ToProperties(properties);
+
+  properties.emplace_back();
+  properties.emplace_back("Replay");
+  properties.emplace_back("Frames Sent", std::to_string(sent_frames_));
+  properties.emplace_back("Message Pool",
+                          std::to_string(message_pool_->MemorySize()),
+                          "bytes");
+  properties.emplace_back("Reused Messages",
+                          std::to_string(data_frame_ring_.NofReused()));
+  if (time_offset_ != 0) {
+    properties.emplace_back("Time Offset",
+                            std::to_string(time_offset_ / 1'000), "us");
+  }
+  properties.emplace_back("Loop", loop_ ? "Yes" : "No");
+  if (loop_) {
+    properties.emplace_back("Loop Gap", std::to_string(loop_gap_ / 1'000),
+                            "us");
+    properties.emplace_back("Nof Loops", std::to_string(nof_loops_));
+  }
+  switch (replay_mode_) {
+    case TypeOfReplay::Firehose: {
+      properties.emplace_back("Mode", "Firehose");
+      properties.emplace_back("Batch Size", std::to_string(batch_size_));
+      properties.emplace_back("Max Queue Size",
+                              std::to_string(max_queue_size_));
+      const double seconds = static_cast<double>(send_time_) / 1'000'000'000;
+      if (seconds > 0.0) {
+        const double frame_rate = static_cast<double>(sent_frames_) / seconds;
+        const double data_rate =
+            static_cast<double>(sent_bytes_) / seconds / 1'000'000;
+        properties.emplace_back("Frame Rate",
+                                std::to_string(frame_rate), "frames/s");
+        properties.emplace_back("Data Rate", std::to_string(data_rate),
+                                "MB/s");
+      }
+      break;
+    }
+
+    case TypeOfReplay::RealTime:
+    default:
+      properties.emplace_back("Mode", "Real-Time");
+      properties.emplace_back("Speed Factor", std::to_string(SpeedFactor()));
+      properties.emplace_back("Mean Jitter",
+                              std::to_string(clock_.MeanJitter() / 1'000),
+                              "us");
+      properties.emplace_back("Max Jitter",
+                              std::to_string(clock_.MaxJitter() / 1'000),
+                              "us");
+      break;
+  }
+  if (!IsEnabling() && !statistics_.Empty()) {
+    statistics_.ToProperties(properties, bit_rate_);
+  }
 }
 
 }  // namespace bus
\ No newline at end of file
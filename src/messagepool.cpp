@@ -0,0 +1,53 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#include "bus/messagepool.h"
+
+#include <new>
+
+namespace bus {
+
+void* MessagePool::Allocate(size_t size) {
+  if (size > kBlockSize) {
+    return ::operator new(size);
+  }
+  std::lock_guard lock(mutex_);
+  if (free_list_ == nullptr) {
+    // The chunk is linked into the free list block by block.
+    auto& chunk = chunk_list_.emplace_back(
+        std::make_unique<std::byte[]>(kBlockSize * kBlocksPerChunk));
+    for (size_t index = kBlocksPerChunk; index > 0; --index) {
+      auto* block = new (chunk.get() + (index - 1) * kBlockSize) FreeBlock;
+      block->next = free_list_;
+      free_list_ = block;
+    }
+  }
+  FreeBlock* block = free_list_;
+  free_list_ = block->next;
+  ++nof_blocks_;
+  return block;
+}
+
+void MessagePool::Deallocate(void* block, size_t size) {
+  if (block == nullptr) {
+    return;
+  }
+  if (size > kBlockSize) {
+    ::operator delete(block);
+    return;
+  }
+  std::lock_guard lock(mutex_);
+  auto* free_block = new (block) FreeBlock;
+  free_block->next = free_list_;
+  free_list_ = free_block;
+  --nof_blocks_;
+}
+
+size_t MessagePool::MemorySize() const {
+  std::lock_guard lock(mutex_);
+  return chunk_list_.size() * kBlockSize * kBlocksPerChunk;
+}
+
+}  // namespace bus
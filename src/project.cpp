@@ -17,6 +17,7 @@
 #include "bus/brokerenvironment.h"
 #include "bus/ienvironment.h"
 #include "bus/dbcdatabase.h"
+#include "bus/mdfplaylist.h"
 #include "bus/mdftrafficgenerator.h"
 
 using namespace std::filesystem;
@@ -30,6 +31,10 @@ constexpr uint16_t kServerPort = 43611;
 
 namespace bus {
 
+Project::~Project() {
+  CancelEnable();
+}
+
 bool Project::IsProjectFile(const std::string& filename) {
   try {
     path project_file(filename);
@@ -70,6 +75,11 @@ void Project::ToProperties(std::vector<BusProperty>& properties) const {
   properties.emplace_back();
   properties.emplace_back("Environments",std::to_string(Environments().size()));
   properties.emplace_back("Databases", std::to_string(Databases().size()));
+  properties.emplace_back("Synchronized Replay",
+                          synchronized_replay_ ? "Yes" : "No");
+  if (coordinator_.NofSources() > 0) {
+    coordinator_.ToProperties(properties);
+  }
 }
 
 bool Project::ReadConfig() {
@@ -102,6 +112,8 @@ bool Project::ReadConfig() {
     }
     Name(root_node->Property<std::string>("Name"));
     Description(root_node->Property<std::string>("Description"));
+    synchronized_replay_ = root_node->Property<bool>("SynchronizedReplay",
+                                                     false);
 
     if (const IXmlNode* envs_node = root_node->GetNode("Environments");
         envs_node != nullptr) {
@@ -189,23 +201,32 @@ bool Project::ReadConfig() {
       }
     }
 
+    // The databases and sources may take some time to read, so they are
+    // enabled in parallel background jobs.
     for (auto& db : Databases()) {
       if (db && db->IsEnabled()) {
-        db->Enable(true);
-        if (!db->IsEnabled()) {
-          LOG_ERROR() << "Didn't enable the database. Name: "
-                      << db->Name();
-        }
+        db->EnableAsync(true, [this, name = db->Name()] (bool enabled) {
+          if (!enabled) {
+            LOG_ERROR() << "Didn't enable the database. Name: " << name;
+          }
+          if (enable_callback_) {
+            enable_callback_();
+          }
+        });
       }
     }
 
     for (auto& source : Sources()) {
       if (source && source->IsEnabled()) {
-        source->Enable(true);
-        if (!source->IsEnabled()) {
-          LOG_ERROR() << "Didn't enable the source task. Name: "
-                      << source->Name();
-        }
+        source->EnableAsync(true, [this, name = source->Name()] (
+                                      bool enabled) {
+          if (!enabled) {
+            LOG_ERROR() << "Didn't enable the source task. Name: " << name;
+          }
+          if (enable_callback_) {
+            enable_callback_();
+          }
+        });
       }
     }
 
@@ -237,6 +258,7 @@ bool Project::WriteConfig() {
     auto& root_node = xml_file->RootName("Project");
     root_node.SetProperty("Name", Name());
     root_node.SetProperty("Description", Description());
+    root_node.SetProperty("SynchronizedReplay", synchronized_replay_);
 
     if (!Environments().empty()) {
       auto& envs_node = root_node.AddNode("Environments");
@@ -401,6 +423,12 @@ ISource* Project::CreateSource(TypeOfSource type) {
       sources_.emplace_back(std::move(mdf_source));
       break;
     }
+
+    case TypeOfSource::MdfPlaylist: {
+      auto playlist = std::make_unique<MdfPlaylist>();
+      sources_.emplace_back(std::move(playlist));
+      break;
+    }
     default:
       return nullptr;
   }
@@ -416,6 +444,8 @@ ISource* Project::GetSource(const std::string& name) const {
 }
 
 void Project::DeleteSource(std::string name) {
+  // The coordinator may reference the source.
+  coordinator_.Clear();
   std::erase_if(sources_, [&name] (const auto& source) -> bool {
     return source && IEquals(source->Name(), name);
   });
@@ -429,6 +459,80 @@ std::vector<std::unique_ptr<ISource>>& Project::Sources() {
   return sources_;
 }
 
+/**
+ * @brief Starts all enabled sources.
+ *
+ * Each source is connected to its environment before it is started. The
+ * environment needs to be started before the sources.
+ */
+void Project::StartSources() {
+  coordinator_.Clear();
+  for (auto& source : sources_) {
+    if (!source || !source->IsEnabled() || source->IsStarted()) {
+      continue;
+    }
+    // In a synchronized replay, the MDF sources are paced by the
+    // coordinator instead of their own replay threads.
+    auto* traffic_generator = dynamic_cast<MdfTrafficGenerator*>(
+        source.get());
+    if (traffic_generator != nullptr) {
+      traffic_generator->ExternalClock(synchronized_replay_);
+    }
+    auto* env = GetEnvironment(source->EnvironmentName());
+    if (env == nullptr) {
+      LOG_ERROR() << "The source has no environment. Source: "
+                  << source->Name() << ", Environment: "
+                  << source->EnvironmentName();
+    } else if (!env->IsStarted()) {
+      LOG_ERROR() << "The source environment is not started. Source: "
+                  << source->Name() << ", Environment: " << env->Name();
+    } else {
+      source->Publisher(env->CreatePublisher());
+    }
+    source->Start();
+    if (synchronized_replay_ && traffic_generator != nullptr &&
+        traffic_generator->IsStarted() && traffic_generator->IsOperable()) {
+      coordinator_.AddSource(*traffic_generator);
+    }
+  }
+  if (coordinator_.NofSources() > 0) {
+    coordinator_.Start();
+  }
+}
+
+bool Project::IsEnabling() const {
+  return std::ranges::any_of(databases_, [] (const auto& db) -> bool {
+           return db && db->IsEnabling();
+         }) ||
+         std::ranges::any_of(sources_, [] (const auto& source) -> bool {
+           return source && source->IsEnabling();
+         });
+}
+
+void Project::CancelEnable() {
+  for (auto& db : databases_) {
+    if (db) {
+      db->CancelEnable();
+    }
+  }
+  for (auto& source : sources_) {
+    if (source) {
+      source->CancelEnable();
+    }
+  }
+}
+
+void Project::StopSources() {
+  coordinator_.Stop();
+  for (auto& source : sources_) {
+    if (!source) {
+      continue;
+    }
+    source->Stop();
+    source->Publisher({});
+  }
+}
+
 IDestination* Project::CreateDestination(TypeOfDestination type) {
   switch (type) {
     case TypeOfDestination::Unknown: {
@@ -0,0 +1,139 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#include "bus/replayclock.h"
+
+#include <algorithm>
+
+using namespace std::chrono;
+
+namespace {
+
+// The last part of a wait is a busy loop. The sleep resolution on some
+// systems is about 1 ms, so the spin time needs some margin.
+constexpr auto kSpinTime = 2ms;
+
+}  // namespace
+
+namespace bus {
+
+void ReplayClock::SpeedFactor(double speed_factor) {
+  {
+    std::lock_guard lock(wait_mutex_);
+    speed_factor_ = std::clamp(speed_factor, kMinSpeedFactor,
+                               kMaxSpeedFactor);
+  }
+  // A waiting replay thread moves its anchor to the new speed.
+  wait_condition_.notify_all();
+}
+
+void ReplayClock::Start(uint64_t first_time) {
+  Anchor(first_time);
+  cancel_ = false;
+  nof_frames_ = 0;
+  sum_jitter_ = 0;
+  max_jitter_ = 0;
+}
+
+void ReplayClock::Anchor(uint64_t first_time) {
+  anchor_speed_factor_ = speed_factor_;
+  first_time_ = first_time;
+  start_clock_ = steady_clock::now();
+  start_wall_time_ = duration_cast<nanoseconds>(
+      system_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Anchors the current replay position at the new speed factor.
+ *
+ * The position is the frame time that is due now at the old speed, so a
+ * speed change neither stalls nor bursts the replay.
+ */
+void ReplayClock::ChangeSpeed() {
+  const auto elapsed = duration_cast<nanoseconds>(
+      steady_clock::now() - start_clock_).count();
+  uint64_t position = first_time_;
+  if (elapsed > 0) {
+    position += anchor_speed_factor_ == 1.0 ?
+        static_cast<uint64_t>(elapsed) :
+        static_cast<uint64_t>(static_cast<double>(elapsed) *
+                              anchor_speed_factor_);
+  }
+  Anchor(position);
+}
+
+nanoseconds ReplayClock::Elapsed(uint64_t frame_time) const {
+  if (frame_time <= first_time_) {
+    return nanoseconds(0);
+  }
+  const uint64_t rel_ns = frame_time - first_time_;
+  const double speed_factor = anchor_speed_factor_;
+  if (speed_factor == 1.0) {
+    // Real-time replay keeps the exact integer time.
+    return nanoseconds(static_cast<int64_t>(rel_ns));
+  }
+  const auto rel_time = static_cast<double>(rel_ns);
+  return nanoseconds(static_cast<int64_t>(rel_time / speed_factor));
+}
+
+uint64_t ReplayClock::WallTime(uint64_t frame_time) const {
+  return start_wall_time_ + Elapsed(frame_time).count();
+}
+
+bool ReplayClock::WaitUntil(uint64_t frame_time) {
+  if (IsSpeedChanged()) {
+    ChangeSpeed();
+  }
+  auto target = start_clock_ + Elapsed(frame_time);
+  while (target - steady_clock::now() > kSpinTime) {
+    {
+      std::unique_lock lock(wait_mutex_);
+      wait_condition_.wait_until(lock, target - kSpinTime, [&] {
+        return cancel_.load() || IsSpeedChanged();
+      });
+    }
+    if (cancel_ || !IsSpeedChanged()) {
+      break;
+    }
+    // The speed changed during the wait, so the target has moved.
+    ChangeSpeed();
+    target = start_clock_ + Elapsed(frame_time);
+  }
+
+  auto now = steady_clock::now();
+  while (now < target) {
+    if (cancel_) {
+      break;
+    }
+    now = steady_clock::now();
+  }
+  if (cancel_) {
+    return false;
+  }
+
+  const auto jitter = static_cast<uint64_t>(
+      duration_cast<nanoseconds>(now - target).count());
+  ++nof_frames_;
+  sum_jitter_ += jitter;
+  if (jitter > max_jitter_) {
+    max_jitter_ = jitter;
+  }
+  return true;
+}
+
+void ReplayClock::Cancel() {
+  {
+    std::lock_guard lock(wait_mutex_);
+    cancel_ = true;
+  }
+  wait_condition_.notify_all();
+}
+
+uint64_t ReplayClock::MeanJitter() const {
+  const uint64_t nof_frames = nof_frames_;
+  return nof_frames > 0 ? sum_jitter_ / nof_frames : 0;
+}
+
+}  // namespace bus
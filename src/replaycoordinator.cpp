@@ -0,0 +1,119 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#include "bus/replaycoordinator.h"
+
+#include <functional>
+#include <queue>
+#include <utility>
+
+#include <util/logstream.h>
+
+#include "bus/mdftrafficgenerator.h"
+
+using namespace util::log;
+
+namespace bus {
+
+ReplayCoordinator::~ReplayCoordinator() {
+  Stop();
+}
+
+void ReplayCoordinator::AddSource(MdfTrafficGenerator& source) {
+  SourceCursor cursor;
+  cursor.source = &source;
+  source_list_.emplace_back(cursor);
+}
+
+void ReplayCoordinator::Clear() {
+  Stop();
+  source_list_.clear();
+}
+
+uint64_t ReplayCoordinator::FrameTime(const SourceCursor& cursor) {
+  const auto time = static_cast<int64_t>(
+      cursor.source->GetMessage(cursor.index).Timestamp())
+      + cursor.source->TimeOffset();
+  return time > 0 ? static_cast<uint64_t>(time) : 0;
+}
+
+void ReplayCoordinator::Start() {
+  Stop();
+  uint64_t first_time = 0;
+  bool first = true;
+  for (auto& cursor : source_list_) {
+    cursor.index = cursor.source->StartIndex();
+    if (cursor.index >= cursor.source->NofMessages()) {
+      continue;
+    }
+    const uint64_t time = FrameTime(cursor);
+    if (first || time < first_time) {
+      first_time = time;
+      first = false;
+    }
+  }
+  clock_.Start(first_time);
+  thread_ = std::thread(&ReplayCoordinator::ReplayThread, this);
+}
+
+void ReplayCoordinator::Stop() {
+  clock_.Cancel();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+/**
+ * @brief Merges and publishes the source frames.
+ *
+ * The heap holds the next frame time of each source. As each source only
+ * has one entry, the source index is a deterministic tie-breaker. When a
+ * streaming source reaches the end of its window, the next window is read.
+ */
+void ReplayCoordinator::ReplayThread() {
+  using HeapItem = std::pair<uint64_t, size_t>;
+  std::priority_queue<HeapItem, std::vector<HeapItem>, std::greater<>> heap;
+  for (size_t source = 0; source < source_list_.size(); ++source) {
+    const auto& cursor = source_list_[source];
+    if (cursor.index < cursor.source->NofMessages()) {
+      heap.emplace(FrameTime(cursor), source);
+    }
+  }
+
+  while (!heap.empty() && !clock_.IsCancelled()) {
+    const auto [frame_time, source] = heap.top();
+    heap.pop();
+    if (!clock_.WaitUntil(frame_time)) {
+      break;
+    }
+    auto& cursor = source_list_[source];
+    cursor.source->PublishFrame(cursor.index, clock_.WallTime(frame_time));
+    ++cursor.index;
+    if (cursor.index >= cursor.source->NofMessages()) {
+      if (!cursor.source->IsStreaming() || !cursor.source->NextWindow()) {
+        continue;
+      }
+      cursor.index = 0;
+    }
+    heap.emplace(FrameTime(cursor), source);
+  }
+  LOG_TRACE() << "Synchronized replay ended. Sources: "
+    << source_list_.size() << ", Frames: " << clock_.NofFrames();
+}
+
+void ReplayCoordinator::ToProperties(
+    std::vector<BusProperty>& properties) const {
+  properties.emplace_back();
+  properties.emplace_back("Synchronized Replay");
+  properties.emplace_back("Sources", std::to_string(source_list_.size()));
+  properties.emplace_back("Speed Factor", std::to_string(SpeedFactor()));
+  properties.emplace_back("Frames Sent", std::to_string(clock_.NofFrames()));
+  properties.emplace_back("Mean Jitter",
+                          std::to_string(clock_.MeanJitter() / 1'000), "us");
+  properties.emplace_back("Max Jitter",
+                          std::to_string(clock_.MaxJitter() / 1'000), "us");
+}
+
+}  // namespace bus
@@ -0,0 +1,486 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#include "bus/signaldecoder.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <limits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+using namespace dbc;
+
+namespace {
+
+/** \brief Bit position in the big endian (Motorola) linear numbering.
+ *
+ * The linear numbering starts with the MSB of the first byte, while the
+ * DBC start bit of a big endian signal uses the sawtooth numbering.
+ */
+constexpr size_t LinearBit(size_t sawtooth_bit) {
+  return (sawtooth_bit / 8) * 8 + (7 - sawtooth_bit % 8);
+}
+
+/** \brief Loads a byte aligned value of the size of T. */
+template <typename T, bool LittleEndian>
+uint64_t LoadAligned(const uint8_t* data) {
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  constexpr bool kNativeLittle = std::endian::native == std::endian::little;
+  if constexpr (LittleEndian != kNativeLittle) {
+    value = std::byteswap(value);
+  }
+  return value;
+}
+
+/** \brief Loads 8 bytes from the offset, zero padded at the frame end. */
+template <bool LittleEndian>
+uint64_t LoadWord(std::span<const uint8_t> data, size_t offset) {
+  if (offset + 8 <= data.size()) {
+    return LoadAligned<uint64_t, LittleEndian>(data.data() + offset);
+  }
+  uint64_t word = 0;
+  for (size_t index = offset; index < data.size(); ++index) {
+    const size_t shift = LittleEndian ? 8 * (index - offset)
+                                      : 56 - 8 * (index - offset);
+    word |= static_cast<uint64_t>(data[index]) << shift;
+  }
+  return word;
+}
+
+uint64_t ExtractGeneric(const bus::SignalDecodeOp& op,
+                        std::span<const uint8_t> data) {
+  uint64_t raw = 0;
+  for (size_t bit = 0; bit < op.bit_length; ++bit) {
+    const size_t position = op.little_endian ? op.start_bit + bit
+                                             : op.start_bit - bit;
+    const size_t byte = position / 8;
+    const size_t bit_in_byte = op.little_endian ? position % 8
+                                                : 7 - position % 8;
+    if (byte < data.size() && ((data[byte] >> bit_in_byte) & 1) != 0) {
+      raw |= uint64_t{1} << bit;
+    }
+  }
+  return raw;
+}
+
+bus::SignalDecodeOp::Kernel SelectKernel(bool little_endian, size_t length,
+                                         bool aligned, bool generic) {
+  using Kernel = bus::SignalDecodeOp::Kernel;
+  if (generic) {
+    return Kernel::Generic;
+  }
+  if (aligned) {
+    switch (length) {
+      case 8:
+        return Kernel::Aligned8;
+
+      case 16:
+        return little_endian ? Kernel::AlignedLittle16 : Kernel::AlignedBig16;
+
+      case 32:
+        return little_endian ? Kernel::AlignedLittle32 : Kernel::AlignedBig32;
+
+      case 64:
+        return little_endian ? Kernel::AlignedLittle64 : Kernel::AlignedBig64;
+
+      default:
+        break;
+    }
+  }
+  return little_endian ? Kernel::WordLittle : Kernel::WordBig;
+}
+
+// Integers of up to 51 bits are converted to double by adding them to the
+// mantissa of 2^52 + 2^51, which is exact for signed values as well.
+constexpr size_t kMaxVectorBits = 51;
+constexpr uint64_t kMagicBits = 0x4338000000000000;
+constexpr double kMagic = 6755399441055744.0;
+
+constexpr size_t kBatchSize = 1'024;  // Frames per cache sized chunk.
+
+template <bool LittleEndian>
+void LoadColumn(std::span<const uint8_t> rows, size_t stride, size_t offset,
+                std::span<uint64_t> dest) {
+  const uint8_t* row = rows.data() + offset;
+  for (auto& word : dest) {
+    word = LoadAligned<uint64_t, LittleEndian>(row);
+    row += stride;
+  }
+}
+
+/**
+ * @brief Converts loaded words to physical values.
+ *
+ * The shift, mask, sign extension and scaling of integer signals of up to
+ * 51 bits are done with AVX2 or SSE2 when the build target supports it.
+ * Other signals and the tail use the scalar conversion.
+ */
+void ConvertColumn(const bus::SignalDecodeOp& op,
+                   std::span<const uint64_t> words, std::span<double> dest,
+                   bool vectorize) {
+  using ValueType = bus::SignalDecodeOp::ValueType;
+  const size_t count = words.size();
+  size_t index = 0;
+  const bool vector = vectorize && op.bit_length <= kMaxVectorBits &&
+      (op.value_type == ValueType::Unsigned ||
+       op.value_type == ValueType::Signed);
+  // Sign extension is (value ^ sign) - sign, a no-op for unsigned values.
+  const uint64_t sign = op.value_type == ValueType::Signed ?
+      uint64_t{1} << (op.bit_length - 1) : 0;
+#if defined(__AVX2__)
+  if (vector) {
+    const __m128i shift = _mm_cvtsi32_si128(op.shift);
+    const __m256i mask = _mm256_set1_epi64x(static_cast<int64_t>(op.mask));
+    const __m256i sign_bit = _mm256_set1_epi64x(static_cast<int64_t>(sign));
+    const __m256i magic_bits =
+        _mm256_set1_epi64x(static_cast<int64_t>(kMagicBits));
+    const __m256d magic = _mm256_set1_pd(kMagic);
+    const __m256d scale = _mm256_set1_pd(op.scale);
+    const __m256d offset = _mm256_set1_pd(op.offset);
+    for (; index + 4 <= count; index += 4) {
+      __m256i raw = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i*>(words.data() + index));
+      raw = _mm256_and_si256(_mm256_srl_epi64(raw, shift), mask);
+      raw = _mm256_sub_epi64(_mm256_xor_si256(raw, sign_bit), sign_bit);
+      const __m256d value = _mm256_sub_pd(
+          _mm256_castsi256_pd(_mm256_add_epi64(raw, magic_bits)), magic);
+      _mm256_storeu_pd(dest.data() + index,
+                       _mm256_add_pd(_mm256_mul_pd(value, scale), offset));
+    }
+  }
+#elif defined(__SSE2__) || defined(_M_X64)
+  if (vector) {
+    const __m128i shift = _mm_cvtsi32_si128(op.shift);
+    const __m128i mask = _mm_set1_epi64x(static_cast<int64_t>(op.mask));
+    const __m128i sign_bit = _mm_set1_epi64x(static_cast<int64_t>(sign));
+    const __m128i magic_bits =
+        _mm_set1_epi64x(static_cast<int64_t>(kMagicBits));
+    const __m128d magic = _mm_set1_pd(kMagic);
+    const __m128d scale = _mm_set1_pd(op.scale);
+    const __m128d offset = _mm_set1_pd(op.offset);
+    for (; index + 2 <= count; index += 2) {
+      __m128i raw = _mm_loadu_si128(
+          reinterpret_cast<const __m128i*>(words.data() + index));
+      raw = _mm_and_si128(_mm_srl_epi64(raw, shift), mask);
+      raw = _mm_sub_epi64(_mm_xor_si128(raw, sign_bit), sign_bit);
+      const __m128d value = _mm_sub_pd(
+          _mm_castsi128_pd(_mm_add_epi64(raw, magic_bits)), magic);
+      _mm_storeu_pd(dest.data() + index,
+                    _mm_add_pd(_mm_mul_pd(value, scale), offset));
+    }
+  }
+#endif
+  for (; index < count; ++index) {
+    dest[index] = bus::SignalDecoder::ToValue(
+        op, (words[index] >> op.shift) & op.mask);
+  }
+}
+
+}  // namespace
+
+namespace bus {
+
+void SignalDecoder::Clear() {
+  plan_list_.clear();
+  nof_signals_ = 0;
+}
+
+SignalDecodeOp SignalDecoder::MakeOp(const Signal& signal) {
+  SignalDecodeOp op;
+  const size_t length = std::clamp<size_t>(signal.BitLength(), 1, 64);
+  op.bit_length = static_cast<uint8_t>(length);
+  op.mask = length >= 64 ? ~uint64_t{0} : (uint64_t{1} << length) - 1;
+  op.little_endian = signal.LittleEndian();
+  op.scale = signal.Scale();
+  op.offset = signal.Offset();
+
+  switch (signal.DataType()) {
+    case SignalDataType::SignedData:
+      op.value_type = SignalDecodeOp::ValueType::Signed;
+      break;
+
+    case SignalDataType::FloatData:
+      op.value_type = length == 32 ? SignalDecodeOp::ValueType::Float
+                                   : SignalDecodeOp::ValueType::Unsigned;
+      break;
+
+    case SignalDataType::DoubleData:
+      op.value_type = length == 64 ? SignalDecodeOp::ValueType::Double
+                                   : SignalDecodeOp::ValueType::Unsigned;
+      break;
+
+    default:
+      op.value_type = SignalDecodeOp::ValueType::Unsigned;
+      break;
+  }
+
+  size_t lsb;  // Little endian: bit number, big endian: linear bit number.
+  size_t first_byte;
+  size_t last_byte;
+  size_t shift;
+  bool aligned;
+  bool generic;
+  if (op.little_endian) {
+    lsb = signal.BitStart();
+    first_byte = lsb / 8;
+    last_byte = (lsb + length - 1) / 8;
+    shift = lsb % 8;
+    aligned = shift == 0;
+    generic = shift + length > 64;
+  } else {
+    const size_t msb = LinearBit(signal.BitStart());
+    lsb = msb + length - 1;
+    first_byte = msb / 8;
+    last_byte = lsb / 8;
+    const size_t lsb_in_word = lsb - 8 * first_byte;
+    aligned = msb % 8 == 0;
+    generic = lsb_in_word > 63;
+    shift = generic ? 0 : 63 - lsb_in_word;
+  }
+  op.kernel = SelectKernel(op.little_endian, length, aligned, generic);
+  op.byte_offset = static_cast<uint16_t>(first_byte);
+  op.nof_bytes = static_cast<uint16_t>(last_byte + 1);
+  op.start_bit = static_cast<uint16_t>(lsb);
+  op.shift = static_cast<uint8_t>(shift);
+  return op;
+}
+
+void SignalDecoder::AddSignal(uint32_t message_id, const Signal& signal,
+                              DbMetric& metric) {
+  if (signal.IsArrayValue()) {
+    return;
+  }
+  auto op = MakeOp(signal);
+  op.metric = &metric;
+  auto& plan = plan_list_[message_id];
+  switch (signal.Mux()) {
+    case MuxType::Multiplexor:
+      plan.has_multiplexor = true;
+      plan.multiplexor = op;
+      break;
+
+    case MuxType::Multiplexed:
+      op.multiplexed = true;
+      op.mux_value = static_cast<uint64_t>(signal.MuxValue());
+      break;
+
+    default:
+      // Extended multiplexing is decoded as a plain signal.
+      break;
+  }
+  plan.op_list.push_back(op);
+  ++nof_signals_;
+}
+
+/**
+ * @brief Extracts the raw value with the kernel of the signal.
+ *
+ * The kernels are specialized on the load width and byte order at compile
+ * time. The caller shall check that the frame holds the signal bytes.
+ */
+uint64_t SignalDecoder::ExtractRaw(const SignalDecodeOp& op,
+                                   std::span<const uint8_t> data) {
+  const uint8_t* bytes = data.data() + op.byte_offset;
+  switch (op.kernel) {
+    using enum SignalDecodeOp::Kernel;
+    case Aligned8:
+      return *bytes;
+
+    case AlignedLittle16:
+      return LoadAligned<uint16_t, true>(bytes);
+
+    case AlignedLittle32:
+      return LoadAligned<uint32_t, true>(bytes);
+
+    case AlignedLittle64:
+      return LoadAligned<uint64_t, true>(bytes);
+
+    case AlignedBig16:
+      return LoadAligned<uint16_t, false>(bytes);
+
+    case AlignedBig32:
+      return LoadAligned<uint32_t, false>(bytes);
+
+    case AlignedBig64:
+      return LoadAligned<uint64_t, false>(bytes);
+
+    case WordLittle:
+      return (LoadWord<true>(data, op.byte_offset) >> op.shift) & op.mask;
+
+    case WordBig:
+      return (LoadWord<false>(data, op.byte_offset) >> op.shift) & op.mask;
+
+    default:
+      break;
+  }
+  return ExtractGeneric(op, data);
+}
+
+double SignalDecoder::ToValue(const SignalDecodeOp& op, uint64_t raw) {
+  double value;
+  switch (op.value_type) {
+    case SignalDecodeOp::ValueType::Signed:
+      if (op.bit_length < 64 && (raw >> (op.bit_length - 1)) & 1) {
+        raw |= ~op.mask;
+      }
+      value = static_cast<double>(static_cast<int64_t>(raw));
+      break;
+
+    case SignalDecodeOp::ValueType::Float:
+      value = std::bit_cast<float>(static_cast<uint32_t>(raw));
+      break;
+
+    case SignalDecodeOp::ValueType::Double:
+      value = std::bit_cast<double>(raw);
+      break;
+
+    default:
+      value = static_cast<double>(raw);
+      break;
+  }
+  return value * op.scale + op.offset;
+}
+
+bool SignalDecoder::Decode(uint32_t message_id, uint64_t timestamp,
+                           std::span<const uint8_t> data) const {
+  const auto itr = plan_list_.find(message_id);
+  if (itr == plan_list_.cend()) {
+    return false;
+  }
+  const DecodePlan& plan = itr->second;
+  uint64_t mux_value = 0;
+  bool valid_mux = false;
+  if (plan.has_multiplexor && plan.multiplexor.nof_bytes <= data.size()) {
+    mux_value = ExtractRaw(plan.multiplexor, data);
+    valid_mux = true;
+  }
+  for (const auto& op : plan.op_list) {
+    // Signals outside the frame or of another multiplexor value are kept.
+    if (op.nof_bytes > data.size() ||
+        (op.multiplexed && (!valid_mux || op.mux_value != mux_value))) {
+      continue;
+    }
+    op.metric->Value(ToValue(op, ExtractRaw(op, data)), timestamp);
+  }
+  return true;
+}
+
+/**
+ * @brief Decodes the frames column by column.
+ *
+ * The frames are decoded in cache sized chunks. The frame data of a chunk
+ * is first copied into zero padded rows of equal length, so each signal is
+ * one strided 64-bit load per frame followed by a vectorized conversion.
+ */
+bool SignalDecoder::DecodeBatch(uint32_t message_id,
+                                std::span<const CanFrameView> frames,
+                                std::vector<SignalColumn>& columns) const {
+  const auto itr = plan_list_.find(message_id);
+  if (itr == plan_list_.cend()) {
+    columns.clear();
+    return false;
+  }
+  const DecodePlan& plan = itr->second;
+  const size_t count = frames.size();
+  columns.resize(plan.op_list.size());
+  for (size_t column = 0; column < plan.op_list.size(); ++column) {
+    columns[column].metric = plan.op_list[column].metric;
+    columns[column].values.resize(count);
+  }
+
+  size_t stride = 8;
+  for (const auto& op : plan.op_list) {
+    stride = std::max<size_t>({stride, op.byte_offset + 8u, op.nof_bytes});
+  }
+  stride = (stride + 7) / 8 * 8;
+  std::vector<uint8_t> rows(kBatchSize * stride);
+  std::array<uint64_t, kBatchSize> words = {};
+  std::array<uint64_t, kBatchSize> mux_list = {};
+
+  constexpr double kNoValue = std::numeric_limits<double>::quiet_NaN();
+  for (size_t first = 0; first < count; first += kBatchSize) {
+    const auto chunk = frames.subspan(first,
+                                      std::min(kBatchSize, count - first));
+    const std::span<const uint8_t> row_list(rows.data(),
+                                            chunk.size() * stride);
+    const std::span<uint64_t> word_list(words.data(), chunk.size());
+    size_t min_length = std::numeric_limits<size_t>::max();
+    for (size_t index = 0; index < chunk.size(); ++index) {
+      const auto data = chunk[index].DataBytes();
+      min_length = std::min(min_length, data.size());
+      uint8_t* row = rows.data() + index * stride;
+      if (data.size() >= stride) {
+        // Word copies are inlined, which a variable length copy isn't.
+        for (size_t pos = 0; pos < stride; pos += 8) {
+          std::memcpy(row + pos, data.data() + pos, 8);
+        }
+      } else {
+        std::memcpy(row, data.data(), data.size());
+        std::memset(row + data.size(), 0, stride - data.size());
+      }
+    }
+
+    // Returns the op that converts the loaded words.
+    const auto load = [&] (const SignalDecodeOp& op) -> SignalDecodeOp {
+      if (op.kernel == SignalDecodeOp::Kernel::Generic) {
+        for (size_t index = 0; index < chunk.size(); ++index) {
+          word_list[index] = ExtractGeneric(
+              op, row_list.subspan(index * stride, stride));
+        }
+        SignalDecodeOp word_op = op;
+        word_op.shift = 0;
+        return word_op;
+      }
+      if (op.little_endian) {
+        LoadColumn<true>(row_list, stride, op.byte_offset, word_list);
+      } else {
+        LoadColumn<false>(row_list, stride, op.byte_offset, word_list);
+      }
+      return op;
+    };
+
+    if (plan.has_multiplexor) {
+      const auto mux_op = load(plan.multiplexor);
+      for (size_t index = 0; index < chunk.size(); ++index) {
+        mux_list[index] = (word_list[index] >> mux_op.shift) & mux_op.mask;
+      }
+    }
+
+    for (size_t column = 0; column < plan.op_list.size(); ++column) {
+      const auto& op = plan.op_list[column];
+      const std::span<double> dest(columns[column].values.data() + first,
+                                   chunk.size());
+      ConvertColumn(load(op), word_list, dest, vectorize_);
+
+      if (op.nof_bytes > min_length) {
+        for (size_t index = 0; index < chunk.size(); ++index) {
+          if (chunk[index].DataLength() < op.nof_bytes) {
+            dest[index] = kNoValue;
+          }
+        }
+      }
+      if (op.multiplexed) {
+        for (size_t index = 0; index < chunk.size(); ++index) {
+          const bool valid_mux = plan.has_multiplexor &&
+              chunk[index].DataLength() >= plan.multiplexor.nof_bytes;
+          if (!valid_mux || mux_list[index] != op.mux_value) {
+            dest[index] = kNoValue;
+          }
+        }
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace bus
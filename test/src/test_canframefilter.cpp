@@ -0,0 +1,113 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#include <gtest/gtest.h>
+
+#include "bus/canframefilter.h"
+
+namespace bus::test {
+
+TEST(CanFrameFilter, Inactive) {
+  CanFrameFilter filter;
+  EXPECT_FALSE(filter.IsActive());
+  EXPECT_EQ(filter.Hash(), 0);
+  EXPECT_TRUE(filter.Match(1, 0x123, false, 0.0));
+  EXPECT_TRUE(filter.Match(7, 0x1ABCDEF, true, 1'000.0));
+}
+
+TEST(CanFrameFilter, Channels) {
+  CanFrameFilter filter;
+  filter.AddChannel(3);
+  filter.AddChannel(1);
+  filter.AddChannel(3);
+  ASSERT_EQ(filter.Channels().size(), 2);
+  EXPECT_EQ(filter.Channels().front(), 1);
+  EXPECT_TRUE(filter.IsActive());
+  EXPECT_TRUE(filter.Match(1, 0x10, false, 0.0));
+  EXPECT_TRUE(filter.Match(3, 0x10, false, 0.0));
+  EXPECT_FALSE(filter.Match(2, 0x10, false, 0.0));
+}
+
+TEST(CanFrameFilter, StandardIds) {
+  CanFrameFilter filter;
+  EXPECT_TRUE(filter.AddId(0x000, false));
+  EXPECT_TRUE(filter.AddId(0x7FF, false));
+  EXPECT_EQ(filter.NofStandardIds(), 2);
+  EXPECT_TRUE(filter.Match(0, 0x7FF, false, 0.0));
+  EXPECT_FALSE(filter.Match(0, 0x7FE, false, 0.0));
+  // An 11-bit ID isn't a 29-bit ID with the same value.
+  EXPECT_FALSE(filter.Match(0, 0x7FF, true, 0.0));
+}
+
+TEST(CanFrameFilter, InvalidStandardId) {
+  CanFrameFilter filter;
+  EXPECT_FALSE(filter.AddId(0x800, false));
+  EXPECT_FALSE(filter.AddId(0x12345, false));
+  EXPECT_EQ(filter.NofStandardIds(), 0);
+  EXPECT_EQ(filter.NofExtendedIds(), 0);
+  EXPECT_FALSE(filter.IsActive());
+}
+
+TEST(CanFrameFilter, ExtendedIds) {
+  CanFrameFilter filter;
+  EXPECT_TRUE(filter.AddId(0x1ABCDEF, true));
+  // The extended ID flag (bit 31) is ignored.
+  EXPECT_TRUE(filter.AddId(0x80000123, true));
+  EXPECT_FALSE(filter.AddId(0x20000000, true));
+  EXPECT_EQ(filter.NofExtendedIds(), 2);
+  EXPECT_EQ(filter.NofStandardIds(), 0);
+  EXPECT_TRUE(filter.Match(0, 0x1ABCDEF, true, 0.0));
+  EXPECT_TRUE(filter.Match(0, 0x123, true, 0.0));
+  EXPECT_FALSE(filter.Match(0, 0x123, false, 0.0));
+  EXPECT_FALSE(filter.Match(0, 0x1ABCDEE, true, 0.0));
+}
+
+TEST(CanFrameFilter, ErrorFrames) {
+  // Error and overload frames have no real ID and pass an ID filter.
+  CanFrameFilter filter;
+  EXPECT_TRUE(filter.AddId(0x123, false));
+  filter.AddChannel(1);
+  filter.TimeWindow(1.0, 2.0);
+  EXPECT_FALSE(filter.Match(1, 0, false, 1.5));
+  EXPECT_TRUE(filter.Match(1, 0, false, 1.5, false));
+  EXPECT_FALSE(filter.Match(2, 0, false, 1.5, false));
+  EXPECT_FALSE(filter.Match(1, 0, false, 3.0, false));
+}
+
+TEST(CanFrameFilter, TimeWindow) {
+  CanFrameFilter filter;
+  filter.TimeWindow(5.0, 2.0);
+  EXPECT_TRUE(filter.HasTimeWindow());
+  EXPECT_EQ(filter.FromTime(), 2.0);
+  EXPECT_EQ(filter.ToTime(), 5.0);
+  EXPECT_FALSE(filter.Match(0, 0x10, false, 1.9));
+  EXPECT_TRUE(filter.Match(0, 0x10, false, 2.0));
+  EXPECT_TRUE(filter.Match(0, 0x10, false, 5.0));
+  EXPECT_FALSE(filter.Match(0, 0x10, false, 5.1));
+  filter.ClearTimeWindow();
+  EXPECT_FALSE(filter.IsActive());
+}
+
+TEST(CanFrameFilter, Hash) {
+  CanFrameFilter filter1;
+  CanFrameFilter filter2;
+  EXPECT_TRUE(filter1.AddId(0x100, false));
+  EXPECT_TRUE(filter1.AddId(0x1000, true));
+  EXPECT_TRUE(filter2.AddId(0x1000, true));
+  EXPECT_TRUE(filter2.AddId(0x100, false));
+  EXPECT_NE(filter1.Hash(), 0);
+  EXPECT_EQ(filter1.Hash(), filter2.Hash());
+
+  // The same number as an 11-bit or a 29-bit ID is another filter.
+  CanFrameFilter filter3;
+  EXPECT_TRUE(filter3.AddId(0x100, true));
+  EXPECT_TRUE(filter3.AddId(0x1000, true));
+  EXPECT_NE(filter1.Hash(), filter3.Hash());
+
+  filter1.Clear();
+  EXPECT_EQ(filter1.Hash(), 0);
+}
+
+}  // namespace bus::test
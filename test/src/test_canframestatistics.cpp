@@ -0,0 +1,109 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+
+#include <gtest/gtest.h>
+
+#include "bus/canframestatistics.h"
+#include "bus/canframestore.h"
+
+namespace {
+
+constexpr uint32_t kMessageId = 0x100;
+
+void AddFrames(bus::CanFrameStatistics& statistics,
+               std::initializer_list<uint64_t> time_list) {
+  constexpr std::array<uint8_t, 8> data = {};
+  for (const uint64_t time : time_list) {
+    statistics.Add(bus::CanFrameView(time, kMessageId, 1, 8, 0, data));
+  }
+}
+
+}  // namespace
+
+namespace bus::test {
+
+TEST(CanFrameStatistics, Periods) {
+  CanFrameStatistics statistics;
+  AddFrames(statistics, {1'000, 2'000, 2'500, 4'500});
+  const auto id_list = statistics.IdList();
+  ASSERT_EQ(id_list.size(), 1);
+  const auto& id = id_list.front();
+  EXPECT_EQ(id.nof_frames, 4);
+  EXPECT_EQ(id.min_period, 500);
+  EXPECT_EQ(id.max_period, 2'000);
+  EXPECT_EQ(id.AvgPeriod(), 1'166);
+  EXPECT_EQ(statistics.DlcCount()[8], 4);
+}
+
+TEST(CanFrameStatistics, MergeSeparateStreams) {
+  CanFrameStatistics statistics1;
+  CanFrameStatistics statistics2;
+  AddFrames(statistics1, {1'000, 2'000, 3'000});
+  AddFrames(statistics2, {3'100, 4'100, 5'100});
+
+  // The gap between the streams is a period.
+  CanFrameStatistics merged;
+  EXPECT_TRUE(merged.Merge(statistics2));
+  EXPECT_TRUE(merged.Merge(statistics1));
+  const auto id_list = merged.IdList();
+  ASSERT_EQ(id_list.size(), 1);
+  const auto& id = id_list.front();
+  EXPECT_EQ(id.nof_frames, 6);
+  EXPECT_EQ(id.first_time, 1'000);
+  EXPECT_EQ(id.last_time, 5'100);
+  EXPECT_EQ(id.min_period, 100);
+  EXPECT_EQ(id.max_period, 1'000);
+  EXPECT_EQ(merged.NofFrames(), 6);
+  EXPECT_EQ(merged.FirstTime(), 1'000);
+  EXPECT_EQ(merged.LastTime(), 5'100);
+}
+
+TEST(CanFrameStatistics, MergeInterleavedStreams) {
+  CanFrameStatistics statistics1;
+  CanFrameStatistics statistics2;
+  AddFrames(statistics1, {1'000, 3'000});
+  AddFrames(statistics2, {2'900, 4'900});
+
+  CanFrameStatistics merged;
+  EXPECT_TRUE(merged.Merge(statistics1));
+  EXPECT_FALSE(merged.Merge(statistics2));
+
+  // The merged stream gives the exact periods.
+  CanFrameStore store;
+  constexpr std::array<uint8_t, 8> data = {};
+  for (const uint64_t time : {1'000, 2'900, 3'000, 4'900}) {
+    store.Add(time, kMessageId, 1, 8, 0, data);
+  }
+  merged.Compute(store);
+  const auto id_list = merged.IdList();
+  ASSERT_EQ(id_list.size(), 1);
+  const auto& id = id_list.front();
+  EXPECT_EQ(id.min_period, 100);
+  EXPECT_EQ(id.max_period, 1'900);
+}
+
+TEST(CanFrameStatistics, MergeOtherIds) {
+  CanFrameStatistics statistics1;
+  AddFrames(statistics1, {1'000, 2'000});
+  CanFrameStatistics statistics2;
+  constexpr std::array<uint8_t, 2> data = {};
+  statistics2.Add(CanFrameView(1'500, 0x80001234, 2, 2, 0, data));
+
+  CanFrameStatistics merged;
+  EXPECT_TRUE(merged.Merge(statistics1));
+  EXPECT_TRUE(merged.Merge(statistics2));
+  EXPECT_TRUE(merged.Merge(CanFrameStatistics()));
+  const auto id_list = merged.IdList();
+  ASSERT_EQ(id_list.size(), 2);
+  EXPECT_EQ(id_list[0].channel, 1);
+  EXPECT_EQ(id_list[1].message_id, 0x80001234);
+  EXPECT_EQ(merged.NofFrames(), 3);
+}
+
+}  // namespace bus::test
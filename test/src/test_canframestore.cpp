@@ -0,0 +1,199 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "bus/canframestore.h"
+
+namespace {
+
+constexpr uint64_t kBaseTime = 1'700'000'000'000'000'000;
+
+/** \brief Adds a frame with the sequence number as the data byte. */
+void AddFrame(bus::CanFrameStore& store, uint64_t timestamp,
+              uint32_t sequence) {
+  const std::array<uint8_t, 4> data = {
+      static_cast<uint8_t>(sequence), static_cast<uint8_t>(sequence >> 8),
+      static_cast<uint8_t>(sequence >> 16),
+      static_cast<uint8_t>(sequence >> 24)};
+  store.Add(timestamp, sequence, 1, 4, 0, data);
+}
+
+}  // namespace
+
+namespace bus::test {
+
+TEST(CanFrameStore, AddAndRead) {
+  CanFrameStore store;
+  EXPECT_TRUE(store.Empty());
+  EXPECT_EQ(store.At(0).DataLength(), 0);
+
+  constexpr std::array<uint8_t, 3> data = {1, 2, 3};
+  store.Add(kBaseTime, 0x80000123, 2, 3, CanFrameFlag::Dir, data);
+  store.Add(kBaseTime + 10, 0x7FF, 1, 0, 0, {});
+  ASSERT_EQ(store.Size(), 2);
+
+  const auto frame = store.At(0);
+  EXPECT_EQ(frame.Timestamp(), kBaseTime);
+  EXPECT_EQ(frame.MessageId(), 0x80000123);
+  EXPECT_EQ(frame.CanId(), 0x123);
+  EXPECT_TRUE(frame.ExtendedId());
+  EXPECT_EQ(frame.BusChannel(), 2);
+  EXPECT_EQ(frame.Dlc(), 3);
+  EXPECT_TRUE(frame.HasFlag(CanFrameFlag::Dir));
+  EXPECT_EQ(frame.Type(), CanFrameType::DataFrame);
+  EXPECT_TRUE(std::ranges::equal(frame.DataBytes(), data));
+
+  EXPECT_FALSE(store.At(1).ExtendedId());
+  EXPECT_EQ(store.At(1).DataLength(), 0);
+  EXPECT_TRUE(store.IsSorted());
+
+  store.Clear();
+  EXPECT_TRUE(store.Empty());
+}
+
+TEST(CanFrameStore, SortByTime) {
+  // The timestamps differ in several 16-bit digits and have duplicates.
+  std::mt19937_64 random(2025);
+  CanFrameStore store;
+  constexpr uint32_t kNofFrames = 100'000;
+  for (uint32_t sequence = 0; sequence < kNofFrames; ++sequence) {
+    AddFrame(store, kBaseTime + (random() % 50'000'000'000ULL) / 1'000,
+             sequence);
+  }
+  EXPECT_FALSE(store.IsSorted());
+  store.SortByTime();
+  ASSERT_EQ(store.Size(), kNofFrames);
+  EXPECT_TRUE(store.IsSorted());
+
+  std::vector<bool> found(kNofFrames, false);
+  for (size_t index = 0; index < store.Size(); ++index) {
+    const auto frame = store.At(index);
+    const uint32_t sequence = frame.MessageId();
+    ASSERT_LT(sequence, kNofFrames);
+    EXPECT_FALSE(found[sequence]);
+    found[sequence] = true;
+    // The data moves with the frame.
+    EXPECT_EQ(frame.DataBytes()[0], static_cast<uint8_t>(sequence));
+    EXPECT_EQ(frame.DataBytes()[1], static_cast<uint8_t>(sequence >> 8));
+    // The sort is stable.
+    if (index > 0 && store.Timestamp(index - 1) == frame.Timestamp()) {
+      EXPECT_LT(store.At(index - 1).MessageId(), sequence);
+    }
+  }
+}
+
+TEST(CanFrameStore, SortSameDigits) {
+  // All frames have the same upper digits, so those passes are skipped.
+  CanFrameStore store;
+  AddFrame(store, kBaseTime + 3, 0);
+  AddFrame(store, kBaseTime + 1, 1);
+  AddFrame(store, kBaseTime + 2, 2);
+  AddFrame(store, kBaseTime + 1, 3);
+  store.SortByTime();
+  ASSERT_EQ(store.Size(), 4);
+  EXPECT_EQ(store.At(0).MessageId(), 1);
+  EXPECT_EQ(store.At(1).MessageId(), 3);
+  EXPECT_EQ(store.At(2).MessageId(), 2);
+  EXPECT_EQ(store.At(3).MessageId(), 0);
+}
+
+TEST(CanFrameStore, Merge) {
+  CanFrameStore stream1;
+  CanFrameStore stream2;
+  CanFrameStore stream3;
+  AddFrame(stream1, kBaseTime + 10, 0);
+  AddFrame(stream1, kBaseTime + 30, 1);
+  AddFrame(stream1, kBaseTime + 50, 2);
+  // The second stream isn't ordered and shares timestamps with the first.
+  AddFrame(stream2, kBaseTime + 40, 10);
+  AddFrame(stream2, kBaseTime + 10, 11);
+  AddFrame(stream2, kBaseTime + 30, 12);
+  AddFrame(stream3, kBaseTime + 20, 20);
+
+  CanFrameStore merged;
+  AddFrame(merged, kBaseTime, 99);  // Replaced by the merge.
+  merged.Merge({&stream1, nullptr, &stream2, &stream3});
+  ASSERT_EQ(merged.Size(), 7);
+  EXPECT_TRUE(merged.IsSorted());
+  EXPECT_TRUE(stream2.IsSorted());
+
+  // Equal timestamps are ordered by stream index.
+  constexpr std::array<uint32_t, 7> expected = {0, 11, 20, 1, 12, 10, 2};
+  for (size_t index = 0; index < merged.Size(); ++index) {
+    const auto frame = merged.At(index);
+    EXPECT_EQ(frame.MessageId(), expected[index]);
+    EXPECT_EQ(frame.DataBytes()[0], static_cast<uint8_t>(expected[index]));
+  }
+}
+
+TEST(CanFrameStore, MergeEmpty) {
+  CanFrameStore stream;
+  CanFrameStore merged;
+  AddFrame(merged, kBaseTime, 1);
+  merged.Merge({&stream, nullptr});
+  EXPECT_TRUE(merged.Empty());
+  merged.Merge({});
+  EXPECT_TRUE(merged.Empty());
+}
+
+TEST(CanFrameStore, TimeSearch) {
+  // Every timestamp occurs three times and one run of equal timestamps
+  // crosses a time index block boundary.
+  constexpr size_t kNofFrames = 3 * CanFrameStore::kTimeIndexStep + 100;
+  constexpr size_t kRunBegin = CanFrameStore::kTimeIndexStep - 50;
+  constexpr size_t kRunEnd = CanFrameStore::kTimeIndexStep + 50;
+  std::vector<uint64_t> time_list;
+  for (size_t index = 0; index < kNofFrames; ++index) {
+    const size_t step = index < kRunBegin || index >= kRunEnd ?
+        index / 3 : kRunBegin / 3;
+    time_list.push_back(kBaseTime + step * 10);
+  }
+  CanFrameStore store;
+  for (size_t index = 0; index < kNofFrames; ++index) {
+    AddFrame(store, time_list[index], static_cast<uint32_t>(index));
+  }
+  ASSERT_TRUE(store.IsSorted());
+
+  for (uint64_t time = kBaseTime - 20; time <= time_list.back() + 20;
+       time += 5) {
+    const auto lower = static_cast<size_t>(
+        std::ranges::lower_bound(time_list, time) - time_list.begin());
+    const auto upper = static_cast<size_t>(
+        std::ranges::upper_bound(time_list, time) - time_list.begin());
+    ASSERT_EQ(store.LowerBound(time), lower) << time - kBaseTime;
+    ASSERT_EQ(store.UpperBound(time), upper) << time - kBaseTime;
+  }
+
+  const uint64_t run_time = time_list[kRunBegin];
+  EXPECT_EQ(store.LowerBound(run_time), kRunBegin - kRunBegin % 3);
+  EXPECT_EQ(store.UpperBound(run_time), kRunEnd);
+
+  const auto [first, last] = store.TimeRange(kBaseTime + 10, kBaseTime + 20);
+  EXPECT_EQ(first, 3);
+  EXPECT_EQ(last, 9);
+  const auto [all_first, all_last] = store.TimeRange(0, UINT64_MAX);
+  EXPECT_EQ(all_first, 0);
+  EXPECT_EQ(all_last, kNofFrames);
+  const auto [none_first, none_last] = store.TimeRange(kBaseTime + 20,
+                                                       kBaseTime + 10);
+  EXPECT_EQ(none_first, none_last);
+}
+
+TEST(CanFrameStore, TimeSearchEmpty) {
+  const CanFrameStore store;
+  EXPECT_EQ(store.LowerBound(kBaseTime), 0);
+  EXPECT_EQ(store.UpperBound(kBaseTime), 0);
+  const auto [first, last] = store.TimeRange(0, UINT64_MAX);
+  EXPECT_EQ(first, last);
+}
+
+}  // namespace bus::test
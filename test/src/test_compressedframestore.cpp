@@ -0,0 +1,146 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "bus/canframestore.h"
+#include "bus/compressedframestore.h"
+
+namespace {
+
+constexpr uint64_t kBaseTime = 1'700'000'000'000'000'000;
+
+/** \brief Creates a sorted store with data, remote, error and FD frames. */
+bus::CanFrameStore MakeStore(size_t nof_frames) {
+  using namespace bus;
+  CanFrameStore store;
+  std::array<uint8_t, 64> data = {};
+  uint64_t time = kBaseTime;
+  for (size_t index = 0; index < nof_frames; ++index) {
+    // Every fifth frame has the same timestamp as the previous frame.
+    time += index % 5 == 0 ? 0 : 100 + index % 7;
+    const auto counter = static_cast<uint8_t>(index / 10);
+    switch (index % 6) {
+      case 0:  // Data changes every tenth frame, so it is often repeated.
+        data.fill(counter);
+        store.Add(time, 0x100, 1, 8, 0, std::span(data).first(8));
+        break;
+
+      case 1:
+        store.Add(time, 0x7FF, 2, 0,
+                  TagFrameFlags(0, CanFrameType::RemoteFrame), {});
+        break;
+
+      case 2:
+        store.Add(time, 0x10, 1, 0,
+                  TagFrameFlags(0, CanFrameType::ErrorFrame, 2), {},
+                  static_cast<uint16_t>(index % 100));
+        break;
+
+      case 3:  // CAN FD frame with 64 bytes.
+        data.fill(static_cast<uint8_t>(index));
+        store.Add(time, 0x80012345, 1, 15,
+                  CanFrameFlag::Edl | CanFrameFlag::Brs, data);
+        break;
+
+      default:
+        data.fill(counter);
+        data[0] = static_cast<uint8_t>(index);
+        store.Add(time, 0x200 + static_cast<uint32_t>(index % 3), 1, 4,
+                  CanFrameFlag::Dir, std::span(data).first(4));
+        break;
+    }
+  }
+  return store;
+}
+
+}  // namespace
+
+namespace bus::test {
+
+TEST(CompressedFrameStore, RoundTrip) {
+  const auto store = MakeStore(2 * CompressedFrameStore::kBlockSize + 123);
+  CompressedFrameStore compressed;
+  compressed.Compress(store);
+  ASSERT_EQ(compressed.Size(), store.Size());
+  EXPECT_EQ(compressed.FirstTime(), store.Timestamp(0));
+  EXPECT_EQ(compressed.LastTime(), store.Timestamp(store.Size() - 1));
+  EXPECT_EQ(compressed.RawSize(), store.MemorySize());
+  EXPECT_LT(compressed.MemorySize(), compressed.RawSize());
+
+  for (size_t index = 0; index < store.Size(); ++index) {
+    const auto expected = store.At(index);
+    const auto actual = compressed.At(index);
+    ASSERT_EQ(actual.Timestamp(), expected.Timestamp()) << index;
+    ASSERT_EQ(compressed.Timestamp(index), expected.Timestamp()) << index;
+    ASSERT_EQ(actual.MessageId(), expected.MessageId()) << index;
+    ASSERT_EQ(actual.BusChannel(), expected.BusChannel()) << index;
+    ASSERT_EQ(actual.Dlc(), expected.Dlc()) << index;
+    ASSERT_EQ(actual.Flags(), expected.Flags()) << index;
+    ASSERT_EQ(actual.BitPosition(), expected.BitPosition()) << index;
+    ASSERT_TRUE(std::ranges::equal(actual.DataBytes(),
+                                   expected.DataBytes())) << index;
+  }
+  EXPECT_EQ(compressed.At(store.Size()).DataLength(), 0);
+}
+
+TEST(CompressedFrameStore, TimeSearch) {
+  const auto store = MakeStore(3 * CompressedFrameStore::kBlockSize);
+  CompressedFrameStore compressed;
+  compressed.Compress(store);
+
+  // The times before, between and after the frames and at block borders.
+  std::vector<uint64_t> time_list = {0, kBaseTime - 1, UINT64_MAX};
+  for (size_t index = 0; index < store.Size(); index += 97) {
+    time_list.push_back(store.Timestamp(index));
+    time_list.push_back(store.Timestamp(index) + 1);
+  }
+  for (size_t block = 1; block < 3; ++block) {
+    const size_t index = block * CompressedFrameStore::kBlockSize;
+    time_list.push_back(store.Timestamp(index - 1));
+    time_list.push_back(store.Timestamp(index));
+  }
+  for (const uint64_t time : time_list) {
+    ASSERT_EQ(compressed.LowerBound(time), store.LowerBound(time)) << time;
+    ASSERT_EQ(compressed.UpperBound(time), store.UpperBound(time)) << time;
+  }
+
+  const uint64_t from = store.Timestamp(1'000);
+  const uint64_t to = store.Timestamp(9'000);
+  EXPECT_EQ(compressed.TimeRange(from, to), store.TimeRange(from, to));
+  const auto [first, last] = compressed.TimeRange(to, from);
+  EXPECT_EQ(first, last);
+}
+
+TEST(CompressedFrameStore, Recompress) {
+  // A new content isn't read from the decoded blocks of the old content.
+  CompressedFrameStore compressed;
+  compressed.Compress(MakeStore(100));
+  const uint64_t old_time = compressed.Timestamp(50);
+
+  CanFrameStore store;
+  constexpr std::array<uint8_t, 1> data = {0xAA};
+  for (size_t index = 0; index < 100; ++index) {
+    store.Add(kBaseTime + 1'000'000 + index, 0x42, 3, 1, 0, data);
+  }
+  compressed.Compress(store);
+  EXPECT_NE(compressed.Timestamp(50), old_time);
+  EXPECT_EQ(compressed.Timestamp(50), store.Timestamp(50));
+  EXPECT_EQ(compressed.At(50).MessageId(), 0x42);
+  EXPECT_EQ(compressed.At(50).DataBytes()[0], 0xAA);
+
+  compressed.Clear();
+  EXPECT_TRUE(compressed.Empty());
+  EXPECT_EQ(compressed.FirstTime(), 0);
+  EXPECT_EQ(compressed.LowerBound(kBaseTime), 0);
+}
+
+}  // namespace bus::test
@@ -0,0 +1,76 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "bus/dbmetric.h"
+
+namespace bus::test {
+
+TEST(DbMetric, Value) {
+  DbMetric metric;
+  EXPECT_FALSE(metric.IsValid());
+  EXPECT_EQ(metric.Timestamp(), 0);
+
+  metric.Value(12.5, 1'000);
+  const auto snapshot = metric.Snapshot();
+  EXPECT_TRUE(snapshot.valid);
+  EXPECT_EQ(snapshot.value, 12.5);
+  EXPECT_EQ(snapshot.timestamp, 1'000);
+  EXPECT_EQ(metric.Value(), 12.5);
+
+  metric.ResetValue();
+  EXPECT_FALSE(metric.IsValid());
+  EXPECT_EQ(metric.Value(), 0.0);
+  EXPECT_EQ(metric.Timestamp(), 0);
+}
+
+TEST(DbMetric, ConcurrentSnapshots) {
+  // The writer sets the value equal to the timestamp, so a torn snapshot
+  // has a value that differs from its timestamp.
+  constexpr uint64_t kNofValues = 200'000;
+  DbMetric metric;
+  std::atomic<bool> done = false;
+  std::atomic<uint64_t> nof_torn = 0;
+  std::atomic<uint64_t> nof_backwards = 0;
+
+  std::vector<std::thread> reader_list;
+  for (size_t reader = 0; reader < 3; ++reader) {
+    reader_list.emplace_back([&] {
+      uint64_t last_time = 0;
+      while (!done.load()) {
+        const auto snapshot = metric.Snapshot();
+        if (!snapshot.valid) {
+          continue;
+        }
+        if (snapshot.value != static_cast<double>(snapshot.timestamp)) {
+          ++nof_torn;
+        }
+        if (snapshot.timestamp < last_time) {
+          ++nof_backwards;
+        }
+        last_time = snapshot.timestamp;
+      }
+    });
+  }
+
+  for (uint64_t time = 1; time <= kNofValues; ++time) {
+    metric.Value(static_cast<double>(time), time);
+  }
+  done = true;
+  for (auto& reader : reader_list) {
+    reader.join();
+  }
+  EXPECT_EQ(nof_torn, 0);
+  EXPECT_EQ(nof_backwards, 0);
+  EXPECT_EQ(metric.Timestamp(), kNofValues);
+}
+
+}  // namespace bus::test
@@ -0,0 +1,172 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "bus/canframestore.h"
+#include "bus/framecache.h"
+
+using namespace std::filesystem;
+
+namespace {
+
+constexpr uint64_t kStartTime = 1'700'000'000'000'000'000;
+constexpr uint64_t kContentKey = 0x1234;
+
+// Layout of the cache file with 4 frames. The header is 88 bytes and each
+// column is aligned to 8 bytes. The frames have 0, 3, 11, 11 and 11 as
+// data offsets.
+constexpr size_t kOffsetPos = 88 + 32 + 16 + 8 + 8 + 8;
+
+}  // namespace
+
+namespace bus::test {
+
+class FrameCacheTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    mdf_file_ = (temp_directory_path() / "test_framecache.mf4").string();
+    std::ofstream file(mdf_file_, std::ios::binary | std::ios::trunc);
+    file << "MDF     4.10    " << std::string(100, 'x');
+    file.close();
+
+    constexpr std::array<uint8_t, 3> data = {1, 2, 3};
+    constexpr std::array<uint8_t, 8> data_fd = {8, 7, 6, 5, 4, 3, 2, 1};
+    store_.Add(100, 0x123, 1, 3, 0, data);
+    store_.Add(200, 0x80000456, 2, 8, CanFrameFlag::Edl, data_fd);
+    store_.Add(300, 0x10, 1, 0,
+               TagFrameFlags(0, CanFrameType::ErrorFrame, 3), {}, 42);
+    store_.Add(400, 0x7FF, 1, 0, TagFrameFlags(0, CanFrameType::RemoteFrame),
+               {});
+  }
+
+  void TearDown() override {
+    FrameCache(mdf_file_, kContentKey).Remove();
+    FrameCache(mdf_file_, kContentKey + 1).Remove();
+    std::error_code dummy;
+    remove(mdf_file_, dummy);
+  }
+
+  std::string mdf_file_;
+  CanFrameStore store_;
+};
+
+TEST_F(FrameCacheTest, SaveAndLoad) {
+  FrameCache cache(mdf_file_, kContentKey);
+  EXPECT_FALSE(cache.IsValid());
+  ASSERT_TRUE(cache.Save(store_, kStartTime));
+  EXPECT_TRUE(cache.IsValid());
+
+  CanFrameStore store;
+  uint64_t start_time = 0;
+  ASSERT_TRUE(cache.Load(store, start_time));
+  EXPECT_TRUE(store.IsMapped());
+  EXPECT_EQ(start_time, kStartTime);
+  ASSERT_EQ(store.Size(), store_.Size());
+  for (size_t index = 0; index < store.Size(); ++index) {
+    const auto expected = store_.At(index);
+    const auto actual = store.At(index);
+    EXPECT_EQ(actual.Timestamp(), expected.Timestamp());
+    EXPECT_EQ(actual.MessageId(), expected.MessageId());
+    EXPECT_EQ(actual.BusChannel(), expected.BusChannel());
+    EXPECT_EQ(actual.Dlc(), expected.Dlc());
+    EXPECT_EQ(actual.Flags(), expected.Flags());
+    EXPECT_EQ(actual.Type(), expected.Type());
+    EXPECT_EQ(actual.BitPosition(), expected.BitPosition());
+    EXPECT_TRUE(std::ranges::equal(actual.DataBytes(),
+                                   expected.DataBytes()));
+  }
+  EXPECT_EQ(store.At(2).BitPosition(), 42);
+  EXPECT_EQ(store.LowerBound(250), 2);
+
+  // A modified store is copied out of the mapped file.
+  constexpr std::array<uint8_t, 1> data = {9};
+  store.Add(500, 0x1, 1, 1, 0, data);
+  EXPECT_FALSE(store.IsMapped());
+  EXPECT_EQ(store.Size(), 5);
+  EXPECT_EQ(store.At(1).DataBytes()[0], 8);
+}
+
+TEST_F(FrameCacheTest, ContentKey) {
+  ASSERT_TRUE(FrameCache(mdf_file_, kContentKey).Save(store_, kStartTime));
+  FrameCache other_cache(mdf_file_, kContentKey + 1);
+  EXPECT_FALSE(other_cache.IsValid());
+  CanFrameStore store;
+  uint64_t start_time = 0;
+  EXPECT_FALSE(other_cache.Load(store, start_time));
+  EXPECT_FALSE(store.IsMapped());
+}
+
+TEST_F(FrameCacheTest, TwoContentKeys) {
+  // Sources with different filters on the same file keep their caches.
+  FrameCache cache1(mdf_file_, kContentKey);
+  FrameCache cache2(mdf_file_, kContentKey + 1);
+  EXPECT_NE(cache1.CacheFile(), cache2.CacheFile());
+  ASSERT_TRUE(cache1.Save(store_, kStartTime));
+  CanFrameStore store;
+  store.Add(store_.At(0));
+  ASSERT_TRUE(cache2.Save(store, kStartTime));
+  EXPECT_TRUE(cache1.IsValid());
+  EXPECT_TRUE(cache2.IsValid());
+
+  CanFrameStore store1;
+  CanFrameStore store2;
+  uint64_t start_time = 0;
+  ASSERT_TRUE(cache1.Load(store1, start_time));
+  ASSERT_TRUE(cache2.Load(store2, start_time));
+  EXPECT_EQ(store1.Size(), store_.Size());
+  EXPECT_EQ(store2.Size(), 1);
+}
+
+TEST_F(FrameCacheTest, ModifiedMdfFile) {
+  FrameCache cache(mdf_file_, kContentKey);
+  ASSERT_TRUE(cache.Save(store_, kStartTime));
+  {
+    std::ofstream file(mdf_file_, std::ios::binary | std::ios::app);
+    file << "more data";
+  }
+  EXPECT_FALSE(cache.IsValid());
+}
+
+TEST_F(FrameCacheTest, TruncatedCache) {
+  FrameCache cache(mdf_file_, kContentKey);
+  ASSERT_TRUE(cache.Save(store_, kStartTime));
+  resize_file(cache.CacheFile(), file_size(cache.CacheFile()) - 8);
+  CanFrameStore store;
+  uint64_t start_time = 0;
+  EXPECT_FALSE(cache.Load(store, start_time));
+  EXPECT_FALSE(store.IsMapped());
+}
+
+TEST_F(FrameCacheTest, InvalidOffset) {
+  // The last offset points past the payload and a middle offset is less
+  // than the offset before it.
+  constexpr std::array<std::pair<size_t, uint64_t>, 2> kCorruptList = {{
+      {4, 1'000'000}, {2, 2}}};
+  for (const auto& [index, offset] : kCorruptList) {
+    FrameCache cache(mdf_file_, kContentKey);
+    ASSERT_TRUE(cache.Save(store_, kStartTime));
+    {
+      std::fstream file(cache.CacheFile(),
+                        std::ios::binary | std::ios::in | std::ios::out);
+      file.seekp(static_cast<std::streamoff>(kOffsetPos + index * 8));
+      file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+    }
+    CanFrameStore store;
+    uint64_t start_time = 0;
+    EXPECT_FALSE(cache.Load(store, start_time)) << index;
+    EXPECT_FALSE(store.IsMapped()) << index;
+  }
+}
+
+}  // namespace bus::test
@@ -0,0 +1,409 @@
+/*
+* Copyright 2025 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <dbc/dbcfile.h>
+
+#include "bus/canframestore.h"
+#include "bus/dbmetric.h"
+#include "bus/signaldecoder.h"
+
+using namespace dbc;
+
+namespace {
+
+constexpr uint32_t kMessageId = 0x123;
+constexpr uint64_t kTimestamp = 1'000;
+
+Signal MakeSignal(size_t bit_start, size_t bit_length, bool little_endian,
+                  SignalDataType data_type = SignalDataType::UnsignedData) {
+  Signal signal;
+  signal.BitStart(bit_start);
+  signal.BitLength(bit_length);
+  signal.LittleEndian(little_endian);
+  signal.DataType(data_type);
+  return signal;
+}
+
+/** \brief Decodes one signal from one frame and returns the metric. */
+double DecodeOne(const Signal& signal, std::span<const uint8_t> data,
+                 bool* valid = nullptr) {
+  bus::DbMetric metric;
+  bus::SignalDecoder decoder;
+  decoder.AddSignal(kMessageId, signal, metric);
+  EXPECT_TRUE(decoder.Decode(kMessageId, kTimestamp, data));
+  if (valid != nullptr) {
+    *valid = metric.IsValid();
+  }
+  return metric.Value();
+}
+
+/** \brief Extracts the raw value bit by bit as the reference. */
+uint64_t ReferenceRaw(std::span<const uint8_t> data, size_t bit_start,
+                      size_t bit_length, bool little_endian) {
+  uint64_t raw = 0;
+  if (little_endian) {
+    for (size_t bit = 0; bit < bit_length; ++bit) {
+      const size_t pos = bit_start + bit;
+      if ((data[pos / 8] >> (pos % 8)) & 1) {
+        raw |= 1ULL << bit;
+      }
+    }
+    return raw;
+  }
+  // Motorola walks from the MSB in the sawtooth bit numbering.
+  size_t pos = bit_start;
+  for (size_t bit = 0; bit < bit_length; ++bit) {
+    raw = (raw << 1) | ((data[pos / 8] >> (pos % 8)) & 1);
+    pos = pos % 8 == 0 ? pos + 15 : pos - 1;
+  }
+  return raw;
+}
+
+}  // namespace
+
+namespace bus::test {
+
+TEST(SignalDecoder, IntelAligned) {
+  constexpr std::array<uint8_t, 8> data = {0x11, 0x34, 0x12, 0x78,
+                                           0x56, 0x34, 0x12, 0xAA};
+  EXPECT_EQ(DecodeOne(MakeSignal(0, 8, true), data), 0x11);
+  EXPECT_EQ(DecodeOne(MakeSignal(8, 16, true), data), 0x1234);
+  EXPECT_EQ(DecodeOne(MakeSignal(24, 32, true), data), 0x12345678);
+
+  uint64_t value64 = 0;
+  std::memcpy(&value64, data.data(), sizeof(value64));
+  if constexpr (std::endian::native == std::endian::big) {
+    value64 = std::byteswap(value64);
+  }
+  EXPECT_EQ(DecodeOne(MakeSignal(0, 64, true), data),
+            static_cast<double>(value64));
+}
+
+TEST(SignalDecoder, IntelUnaligned) {
+  constexpr std::array<uint8_t, 8> data = {0xAB, 0xCD, 0xEF, 0x01,
+                                           0x00, 0x00, 0x00, 0x80};
+  EXPECT_EQ(DecodeOne(MakeSignal(4, 12, true), data), 0xCDA);
+  EXPECT_EQ(DecodeOne(MakeSignal(3, 1, true), data), 1);
+  EXPECT_EQ(DecodeOne(MakeSignal(63, 1, true), data), 1);
+  EXPECT_EQ(DecodeOne(MakeSignal(12, 20, true), data), 0x1EFC);
+}
+
+TEST(SignalDecoder, IntelOverWordBoundary) {
+  // A 64-bit signal at bit 4 spans 9 bytes.
+  constexpr std::array<uint8_t, 9> data = {0x10, 0x32, 0x54, 0x76, 0x98,
+                                           0xBA, 0xDC, 0xFE, 0x0F};
+  EXPECT_EQ(DecodeOne(MakeSignal(4, 64, true), data),
+            static_cast<double>(0xFFEDCBA987654321ULL));
+}
+
+TEST(SignalDecoder, MotorolaAligned) {
+  constexpr std::array<uint8_t, 8> data = {0x12, 0x34, 0x56, 0x78,
+                                           0x9A, 0xBC, 0xDE, 0xF0};
+  // The start bit is the MSB in the sawtooth bit numbering.
+  EXPECT_EQ(DecodeOne(MakeSignal(7, 8, false), data), 0x12);
+  EXPECT_EQ(DecodeOne(MakeSignal(15, 16, false), data), 0x3456);
+  EXPECT_EQ(DecodeOne(MakeSignal(7, 32, false), data), 0x12345678);
+  EXPECT_EQ(DecodeOne(MakeSignal(7, 64, false), data),
+            static_cast<double>(0x123456789ABCDEF0ULL));
+}
+
+TEST(SignalDecoder, MotorolaUnaligned) {
+  constexpr std::array<uint8_t, 8> data = {0xAB, 0xCD, 0xEF, 0x01,
+                                           0x00, 0x00, 0x00, 0x00};
+  EXPECT_EQ(DecodeOne(MakeSignal(3, 12, false), data), 0xBCD);
+  EXPECT_EQ(DecodeOne(MakeSignal(5, 4, false), data), 0xA);
+  EXPECT_EQ(DecodeOne(MakeSignal(11, 16, false), data), 0xDEF0);
+}
+
+TEST(SignalDecoder, SignedValues) {
+  constexpr std::array<uint8_t, 8> data = {0xFE, 0x0F, 0xFF, 0x00,
+                                           0x80, 0x00, 0x00, 0x00};
+  EXPECT_EQ(DecodeOne(MakeSignal(0, 8, true, SignalDataType::SignedData),
+                      data), -2);
+  // Motorola 12 bits 0xFFF is -1.
+  EXPECT_EQ(DecodeOne(MakeSignal(11, 12, false, SignalDataType::SignedData),
+                      data), -1);
+  EXPECT_EQ(DecodeOne(MakeSignal(24, 16, true, SignalDataType::SignedData),
+                      data), -32768);
+  EXPECT_EQ(DecodeOne(MakeSignal(24, 16, true), data), 32768);
+}
+
+TEST(SignalDecoder, FloatValues) {
+  std::array<uint8_t, 12> data = {};
+  const float value32 = 1.5F;
+  const double value64 = -2.25;
+  std::memcpy(data.data(), &value32, sizeof(value32));
+  std::memcpy(data.data() + 4, &value64, sizeof(value64));
+  if constexpr (std::endian::native == std::endian::little) {
+    EXPECT_EQ(DecodeOne(MakeSignal(0, 32, true, SignalDataType::FloatData),
+                        data), 1.5);
+    EXPECT_EQ(DecodeOne(MakeSignal(32, 64, true, SignalDataType::DoubleData),
+                        data), -2.25);
+  }
+}
+
+TEST(SignalDecoder, ScaleAndOffset) {
+  constexpr std::array<uint8_t, 1> data = {100};
+  auto signal = MakeSignal(0, 8, true);
+  signal.Scale(0.5);
+  signal.Offset(-10.0);
+  EXPECT_DOUBLE_EQ(DecodeOne(signal, data), 40.0);
+}
+
+TEST(SignalDecoder, ShortFrame) {
+  constexpr std::array<uint8_t, 8> data = {};
+  bool valid = true;
+  // The signal needs 9 bytes, so the metric isn't updated.
+  DecodeOne(MakeSignal(56, 16, true), data, &valid);
+  EXPECT_FALSE(valid);
+  DecodeOne(MakeSignal(63, 16, false), data, &valid);
+  EXPECT_FALSE(valid);
+}
+
+TEST(SignalDecoder, Multiplexed) {
+  auto mux = MakeSignal(0, 8, true);
+  mux.Mux(MuxType::Multiplexor);
+  auto signal1 = MakeSignal(8, 8, true);
+  signal1.Mux(MuxType::Multiplexed);
+  signal1.MuxValue(1);
+  auto signal2 = MakeSignal(8, 8, true);
+  signal2.Mux(MuxType::Multiplexed);
+  signal2.MuxValue(2);
+
+  DbMetric mux_metric;
+  DbMetric metric1;
+  DbMetric metric2;
+  SignalDecoder decoder;
+  decoder.AddSignal(kMessageId, mux, mux_metric);
+  decoder.AddSignal(kMessageId, signal1, metric1);
+  decoder.AddSignal(kMessageId, signal2, metric2);
+  EXPECT_EQ(decoder.NofPlans(), 1);
+  EXPECT_EQ(decoder.NofSignals(), 3);
+
+  constexpr std::array<uint8_t, 2> data1 = {1, 42};
+  EXPECT_TRUE(decoder.Decode(kMessageId, kTimestamp, data1));
+  EXPECT_EQ(mux_metric.Value(), 1);
+  EXPECT_EQ(metric1.Value(), 42);
+  EXPECT_FALSE(metric2.IsValid());
+
+  constexpr std::array<uint8_t, 2> data2 = {2, 43};
+  EXPECT_TRUE(decoder.Decode(kMessageId, kTimestamp + 1, data2));
+  EXPECT_EQ(metric1.Value(), 42);
+  EXPECT_EQ(metric1.Timestamp(), kTimestamp);
+  EXPECT_EQ(metric2.Value(), 43);
+  EXPECT_EQ(metric2.Timestamp(), kTimestamp + 1);
+}
+
+TEST(SignalDecoder, UnknownMessage) {
+  DbMetric metric;
+  SignalDecoder decoder;
+  EXPECT_TRUE(decoder.Empty());
+  decoder.AddSignal(kMessageId, MakeSignal(0, 8, true), metric);
+  constexpr std::array<uint8_t, 1> data = {1};
+  EXPECT_FALSE(decoder.Decode(kMessageId + 1, kTimestamp, data));
+  EXPECT_FALSE(metric.IsValid());
+  decoder.Clear();
+  EXPECT_TRUE(decoder.Empty());
+  EXPECT_FALSE(decoder.Decode(kMessageId, kTimestamp, data));
+}
+
+TEST(SignalDecoder, KernelsMatchReference) {
+  // Random signals hit all kernels, both byte orders and all lengths.
+  std::mt19937_64 random(2025);
+  std::vector<uint8_t> data;
+  for (size_t test = 0; test < 100'000; ++test) {
+    data.resize((random() & 1) != 0 ? 8 : 64);
+    for (auto& byte : data) {
+      byte = static_cast<uint8_t>(random());
+    }
+    const size_t nof_bits = data.size() * 8;
+    const size_t bit_length = 1 + random() % 64;
+    const bool little_endian = (random() & 1) != 0;
+    const size_t first_bit = random() % (nof_bits - bit_length + 1);
+    // The Motorola start bit is the MSB in the sawtooth bit numbering.
+    const size_t bit_start = little_endian ? first_bit :
+        (first_bit / 8) * 8 + (7 - first_bit % 8);
+
+    const uint64_t expected = ReferenceRaw(data, bit_start, bit_length,
+                                           little_endian);
+    bool valid = false;
+    const double value = DecodeOne(MakeSignal(bit_start, bit_length,
+                                              little_endian), data, &valid);
+    ASSERT_TRUE(valid);
+    ASSERT_EQ(value, static_cast<double>(expected))
+      << "Start: " << bit_start << ", Length: " << bit_length
+      << ", Little Endian: " << little_endian;
+  }
+}
+
+TEST(SignalDecoder, BatchMatchesDecode) {
+  // Random plans with a multiplexor, multiplexed signals and signals of all
+  // types and byte orders are decoded from frames of random length.
+  constexpr size_t kNofSignals = 12;
+  constexpr size_t kMaxLength = 16;
+  constexpr std::array<double, 4> kScaleList = {1.0, 0.5, -0.25, 3.0};
+  std::mt19937_64 random(23);
+  for (const bool vectorize : {true, false}) {
+    for (size_t round = 0; round < 40; ++round) {
+      std::vector<DbMetric> metric_list(kNofSignals);
+      SignalDecoder decoder;
+      decoder.Vectorize(vectorize);
+
+      Signal multiplexor = MakeSignal(3, 2, false);
+      multiplexor.Mux(MuxType::Multiplexor);
+      decoder.AddSignal(kMessageId, multiplexor, metric_list[0]);
+      for (size_t index = 1; index < kNofSignals; ++index) {
+        const size_t bit_length = index % 4 == 0 ? 52 + random() % 13 :
+            1 + random() % 51;
+        const bool little_endian = (random() & 1) != 0;
+        const size_t first_bit = random() % (kMaxLength * 8 - bit_length + 1);
+        const size_t bit_start = little_endian ? first_bit :
+            (first_bit / 8) * 8 + (7 - first_bit % 8);
+        auto data_type = (random() & 1) != 0 ? SignalDataType::SignedData :
+            SignalDataType::UnsignedData;
+        if (index == 5) {
+          data_type = SignalDataType::FloatData;
+        }
+        Signal signal = MakeSignal(bit_start,
+                                   index == 5 ? 32 : bit_length,
+                                   little_endian, data_type);
+        signal.Scale(kScaleList[random() % kScaleList.size()]);
+        signal.Offset(static_cast<double>(random() % 100) - 50.0);
+        if (index % 3 == 0) {
+          signal.Mux(MuxType::Multiplexed);
+          signal.MuxValue(static_cast<int>(random() % 4));
+        }
+        decoder.AddSignal(kMessageId, signal, metric_list[index]);
+      }
+
+      // More frames than one chunk and not a multiple of the vector width.
+      CanFrameStore store;
+      const size_t nof_frames = 1 + random() % 2'500;
+      std::array<uint8_t, kMaxLength> data = {};
+      for (size_t frame = 0; frame < nof_frames; ++frame) {
+        for (auto& byte : data) {
+          byte = static_cast<uint8_t>(random());
+        }
+        const size_t length = random() % 4 == 0 ?
+            random() % (kMaxLength + 1) : kMaxLength;
+        store.Add(kTimestamp + frame, kMessageId, 1,
+                  static_cast<uint8_t>(length), 0,
+                  std::span(data).first(length));
+      }
+      std::vector<CanFrameView> frame_list;
+      for (size_t frame = 0; frame < store.Size(); ++frame) {
+        frame_list.push_back(store.At(frame));
+      }
+
+      std::vector<SignalColumn> column_list;
+      ASSERT_TRUE(decoder.DecodeBatch(kMessageId, frame_list, column_list));
+      ASSERT_EQ(column_list.size(), kNofSignals);
+      for (size_t frame = 0; frame < frame_list.size(); ++frame) {
+        for (auto& metric : metric_list) {
+          metric.ResetValue();
+        }
+        decoder.Decode(kMessageId, frame_list[frame].Timestamp(),
+                       frame_list[frame].DataBytes());
+        for (size_t column = 0; column < kNofSignals; ++column) {
+          const auto& metric = metric_list[column];
+          ASSERT_EQ(column_list[column].metric, &metric);
+          const double value = column_list[column].values[frame];
+          if (!metric.IsValid() || std::isnan(metric.Value())) {
+            ASSERT_TRUE(std::isnan(value))
+              << "Column: " << column << ", Frame: " << frame;
+          } else {
+            ASSERT_DOUBLE_EQ(value, metric.Value())
+              << "Column: " << column << ", Frame: " << frame
+              << ", Vectorize: " << vectorize;
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(SignalDecoder, BatchUnknownId) {
+  DbMetric metric;
+  SignalDecoder decoder;
+  decoder.AddSignal(kMessageId, MakeSignal(0, 8, true), metric);
+  std::vector<SignalColumn> column_list(1);
+  EXPECT_FALSE(decoder.DecodeBatch(kMessageId + 1, {}, column_list));
+  EXPECT_TRUE(column_list.empty());
+}
+
+// Benchmark of the kernels against the bit by bit reference. It is
+// disabled in the unit tests, run it with --gtest_also_run_disabled_tests.
+TEST(SignalDecoder, DISABLED_KernelSpeed) {
+  struct Shape {
+    const char* name;
+    size_t bit_start;
+    size_t bit_length;
+    bool little_endian;
+  };
+  constexpr std::array<Shape, 7> shape_list = {{
+      {"Aligned8", 8, 8, true},
+      {"AlignedLittle16", 16, 16, true},
+      {"AlignedBig32", 7, 32, false},
+      {"WordLittle", 4, 12, true},
+      {"WordBig", 3, 12, false},
+      {"Generic Little", 4, 64, true},
+      {"Generic Big", 3, 64, false},
+  }};
+  constexpr size_t kNofFrames = 1'000'000;
+  std::array<uint8_t, 16> data = {};
+  for (size_t index = 0; index < data.size(); ++index) {
+    data[index] = static_cast<uint8_t>(index * 37 + 11);
+  }
+
+  // Returns the time per frame in ns.
+  const auto measure = [&] (const auto& decode) -> double {
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t frame = 0; frame < kNofFrames; ++frame) {
+      data[0] = static_cast<uint8_t>(frame);
+      decode(frame);
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        stop - start).count();
+    return static_cast<double>(ns) / kNofFrames;
+  };
+
+  for (const auto& shape : shape_list) {
+    DbMetric metric;
+    SignalDecoder decoder;
+    decoder.AddSignal(kMessageId, MakeSignal(shape.bit_start,
+                                             shape.bit_length,
+                                             shape.little_endian), metric);
+    const double kernel_ns = measure([&] (size_t frame) {
+      decoder.Decode(kMessageId, frame, data);
+    });
+    EXPECT_EQ(metric.Timestamp(), kNofFrames - 1);
+
+    DbMetric reference;
+    const double reference_ns = measure([&] (size_t frame) {
+      const uint64_t raw = ReferenceRaw(data, shape.bit_start,
+                                        shape.bit_length, shape.little_endian);
+      reference.Value(static_cast<double>(raw), frame);
+    });
+    EXPECT_EQ(reference.Value(), metric.Value());
+
+    std::cout << shape.name << ": " << kernel_ns << " ns/frame, Reference: "
+              << reference_ns << " ns/frame, Speedup: "
+              << reference_ns / kernel_ns << std::endl;
+  }
+}
+
+}  // namespace bus::test